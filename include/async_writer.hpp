@@ -0,0 +1,75 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace crawl {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// AsyncFileWriter — overlap disk writes with network receive
+//
+// Download paths used to write synchronously from the receiving thread, so
+// every flush stalled the socket read loop and disk time added onto network
+// time. This stage decouples them: write() queues a copy of the chunk (with
+// its final file offset) and returns immediately; a dedicated writer thread
+// pushes batches to disk. Built with liburing the batch goes out as a queue
+// of pwrite submissions reaped asynchronously (HAVE_LIBURING); otherwise a
+// plain positional-write loop on the writer thread, which still gives full
+// network/disk overlap.
+//
+// The queue is bounded by bytes, so a slow disk backpressures the download
+// instead of ballooning memory. finish() drains, fdatasync()s and closes —
+// when it returns true, every block is durable.
+// ─────────────────────────────────────────────────────────────────────────────
+class AsyncFileWriter {
+public:
+    // Opens (creates/truncates) the file; preallocate > 0 reserves the full
+    // size up front so offset writes never race extending it. Pass
+    // truncate = false to keep existing bytes (resumed downloads).
+    explicit AsyncFileWriter(const std::string& path, size_t preallocate = 0,
+                             bool truncate = true);
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    bool valid() const { return fd_ >= 0; }
+
+    // Queue [data, data+len) for writing at offset. Copies the bytes; blocks
+    // only while the queued-byte budget is full. Returns false once any
+    // earlier write has failed.
+    bool write(size_t offset, const uint8_t* data, size_t len);
+
+    // Drain the queue, make everything durable and close the file.
+    bool finish();
+
+private:
+    static constexpr size_t MAX_QUEUED_BYTES = 32u << 20; // backpressure cap
+
+    struct Chunk {
+        size_t offset;
+        std::vector<uint8_t> data;
+    };
+
+    void run(); // writer thread main loop
+    bool write_batch(std::deque<Chunk>& batch);
+    bool pwrite_full(const Chunk& chunk);
+
+    int fd_ = -1;
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::condition_variable can_push_;
+    std::condition_variable can_pop_;
+    std::deque<Chunk> queue_;
+    size_t queued_bytes_ = 0;
+    bool closing_ = false;
+    bool failed_ = false;
+};
+
+} // namespace crawl
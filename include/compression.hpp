@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <string>
 #include <optional>
+#include <functional>
+#include <memory>
 
 namespace crawl {
 
@@ -48,4 +50,30 @@ private:
 #endif
 };
 
+// Incremental decompressor for the streaming read path: feed compressed
+// chunks as they come off the socket and receive decompressed output through
+// a callback, so decompression overlaps the download and peak memory stays
+// at the decoder window size instead of compressed + decompressed copies.
+class StreamingDecompressor {
+public:
+    using OutputFn = std::function<bool(const uint8_t* data, size_t len)>;
+
+    explicit StreamingDecompressor(CompressionType type);
+    ~StreamingDecompressor();
+
+    // Codec is available and the decoder initialized successfully
+    bool valid() const;
+
+    // Feed a compressed chunk; decompressed output is delivered via `out`.
+    // Returns false on decode error or when `out` aborts.
+    bool feed(const uint8_t* data, size_t len, const OutputFn& out);
+
+    // The decoder has seen the end of the compressed stream
+    bool finished() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 } // namespace crawl
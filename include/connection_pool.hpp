@@ -7,56 +7,85 @@
 #include <memory>
 #include <mutex>
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 
 namespace crawl {
 
 class TLSConnection;
+class HTTP2Session;
 
 struct PooledConnection {
     int socket_fd;
     std::unique_ptr<TLSConnection> tls;
+    std::unique_ptr<HTTP2Session> h2; // live multiplexed session, if negotiated
     std::chrono::steady_clock::time_point last_used;
     bool in_use;
-    
+
     PooledConnection() : socket_fd(-1), in_use(false) {}
 };
 
 class ConnectionPool {
 public:
-    ConnectionPool(int max_connections = 100, 
+    ConnectionPool(int max_connections = 100,
                    std::chrono::seconds idle_timeout = std::chrono::seconds(60));
     ~ConnectionPool();
-    
+
     // Get a connection from pool or create new one
-    std::shared_ptr<PooledConnection> acquire(const std::string& host, 
-                                               int port, 
+    std::shared_ptr<PooledConnection> acquire(const std::string& host,
+                                               int port,
                                                bool use_tls);
-    
+
     // Return connection to pool
-    void release(const std::string& host, int port, 
+    void release(const std::string& host, int port,
                  std::shared_ptr<PooledConnection> conn);
-    
-    // Clean up idle connections
+
+    // Clean up idle connections (also runs periodically on the reaper thread)
     void cleanup_idle();
-    
+
+    // Adjust the global idle-connection cap; excess LRU connections are evicted
+    void set_max_connections(int max_connections);
+
 private:
     struct PoolKey {
         std::string host;
         int port;
         bool use_tls;
-        
+
         bool operator<(const PoolKey& other) const {
             if (host != other.host) return host < other.host;
             if (port != other.port) return port < other.port;
             return use_tls < other.use_tls;
         }
     };
-    
-    int max_connections_;
+
+    // Hosts hash into independent shards, each with its own lock, so batch
+    // workers hitting different hosts never serialize on one pool mutex
+    static constexpr size_t NUM_SHARDS = 16;
+
+    struct Shard {
+        std::mutex mutex;
+        std::map<PoolKey, std::vector<std::shared_ptr<PooledConnection>>> pools;
+    };
+
+    Shard& shard_for(const std::string& host);
+
+    // Drop the least-recently-used idle connection in `shard`; returns true
+    // if one was found and closed. Caller holds the shard lock.
+    bool evict_lru_locked(Shard& shard);
+
+    std::atomic<int> max_connections_;
     std::chrono::seconds idle_timeout_;
-    std::map<PoolKey, std::vector<std::shared_ptr<PooledConnection>>> pools_;
-    std::mutex mutex_;
-    
+    Shard shards_[NUM_SHARDS];
+    std::atomic<int> total_idle_{0}; // idle connections across all shards
+
+    // Background reaper — callers no longer need to invoke cleanup_idle()
+    std::thread reaper_;
+    std::mutex reaper_mutex_;
+    std::condition_variable reaper_cv_;
+    bool shutting_down_ = false;
+
     std::shared_ptr<PooledConnection> create_connection(const std::string& host,
                                                          int port,
                                                          bool use_tls);
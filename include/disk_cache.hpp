@@ -0,0 +1,54 @@
+#pragma once
+
+#include "http_client.hpp"
+#include <string>
+#include <optional>
+#include <mutex>
+
+namespace crawl {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Persistent response cache (RFC 7234 subset)
+//   Each cached URL becomes two files under the cache directory, addressed by
+//   an FNV-1a hash of the URL: <hash>.meta (status, headers, stored time,
+//   freshness lifetime) and <hash>.body. Lookups open the files directly by
+//   hash — no index scan, no global state to rebuild on startup — and writes
+//   go through a temp file + rename so a crash never leaves a torn entry.
+//
+//   Freshness follows Cache-Control: no-store is never written, max-age
+//   bounds the lifetime, no-cache stores with a zero lifetime (always
+//   revalidate). Entries without max-age are stored only when they carry a
+//   validator (ETag / Last-Modified) and are always revalidated; the caller
+//   turns a 304 into a refresh() plus a local read.
+// ─────────────────────────────────────────────────────────────────────────────
+class DiskCache {
+public:
+    explicit DiskCache(const std::string& dir);
+
+    struct Hit {
+        Response response;        // reconstructed from disk, body included
+        bool fresh = false;       // within its lifetime — serve without I/O
+        std::string etag;         // validators for conditional revalidation
+        std::string last_modified;
+    };
+
+    // nullopt on miss or unreadable entry
+    std::optional<Hit> lookup(const std::string& url);
+
+    // Store a 200 response if its headers allow caching; no-op otherwise
+    void store(const std::string& url, const Response& resp);
+
+    // A 304 validated the entry: restart its lifetime using the (possibly
+    // updated) Cache-Control from the 304
+    void refresh(const std::string& url, const Response& resp304);
+
+private:
+    std::string dir_;
+    std::mutex mutex_;
+
+    std::string meta_path(const std::string& url) const;
+    std::string body_path(const std::string& url) const;
+    bool write_meta(const std::string& url, const Response& resp, long max_age);
+};
+
+} // namespace crawl
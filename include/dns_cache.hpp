@@ -3,8 +3,11 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <deque>
 #include <chrono>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <netinet/in.h>
 
 namespace crawl {
@@ -13,24 +16,31 @@ struct CachedAddress {
     std::vector<sockaddr_storage> addresses;
     std::chrono::steady_clock::time_point cached_at;
     std::chrono::seconds ttl;
+    bool negative = false;   // cached resolution failure (NXDOMAIN etc.)
+    bool refreshing = false; // a background re-resolve is already queued
 };
 
 class DNSCache {
 public:
     DNSCache(std::chrono::seconds default_ttl = std::chrono::seconds(300));
-    
-    // Lookup cached address or resolve if not cached
+    ~DNSCache();
+
+    // Lookup cached address or resolve if not cached.
+    // Hot entries are refreshed ahead of expiry on a background thread, and
+    // expired entries are served stale while a refresh runs, so steady-state
+    // lookups never block on getaddrinfo. Failed resolutions are cached
+    // briefly so a dead host doesn't hammer the resolver.
     std::vector<sockaddr_storage> resolve(const std::string& host, int port);
-    
+
     // Pre-populate cache
     void warmup(const std::string& host, int port);
-    
+
     // Clear expired entries
     void cleanup();
-    
+
     // Clear all entries
     void clear();
-    
+
     // Get cache statistics
     struct Stats {
         size_t hits;
@@ -38,17 +48,32 @@ public:
         size_t entries;
     };
     Stats get_stats() const;
-    
+
 private:
     std::unordered_map<std::string, CachedAddress> cache_;
     mutable std::mutex mutex_;
     std::chrono::seconds default_ttl_;
-    
+    std::chrono::seconds negative_ttl_{10};
+
     mutable size_t hits_ = 0;
     mutable size_t misses_ = 0;
-    
+
+    // Background refresher — re-resolves hosts queued by resolve()
+    struct RefreshJob {
+        std::string key;
+        std::string host;
+        int port;
+    };
+    std::thread refresher_;
+    std::mutex refresh_mutex_;
+    std::condition_variable refresh_cv_;
+    std::deque<RefreshJob> refresh_queue_;
+    bool shutting_down_ = false;
+
     std::string make_key(const std::string& host, int port) const;
     std::vector<sockaddr_storage> do_resolve(const std::string& host, int port);
+    void schedule_refresh(const std::string& key, const std::string& host, int port);
+    void refresher_loop();
 };
 
 } // namespace crawl
@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <sys/socket.h>
 #include <netinet/in.h>
 
@@ -17,6 +20,31 @@ struct AddressInfo {
     socklen_t addrlen;
 };
 
+// Per-host outcome cache: remembers which address won the last race so a
+// repeat connect goes straight to the known-good endpoint — no resolution,
+// no staggered attempts. Entries are TTL'd like DNSCache entries and
+// invalidated the moment the remembered endpoint fails, which re-arms the
+// full race. Shared process-wide, keyed "host:port".
+class ConnectOutcomeCache {
+public:
+    static constexpr auto TTL = std::chrono::seconds(300);
+
+    static ConnectOutcomeCache& instance();
+
+    std::optional<AddressInfo> lookup(const std::string& host, int port);
+    void record(const std::string& host, int port, const AddressInfo& addr);
+    void invalidate(const std::string& host, int port);
+
+private:
+    struct Entry {
+        AddressInfo addr;
+        std::chrono::steady_clock::time_point connected_at;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
 // RFC 8305 Happy Eyeballs v2 implementation
 class HappyEyeballs {
 public:
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace crawl {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// HeaderMap — arena-allocated flat header storage
+//
+// A message's headers live in one contiguous byte arena; each entry is four
+// 32-bit offsets into it. Storing a whole response's headers is therefore one
+// or two allocations total (arena + entry vector) instead of an RB-tree node
+// and two heap strings per header, and iteration walks memory linearly. At
+// crawl rates the per-header map nodes were a top-five entry in the allocator
+// profile, which is why this is flat and not clever.
+//
+// Lookup is case-insensitive (header names are, per RFC 9110) and linear —
+// messages carry a few dozen headers at most, so a scan beats any index.
+// Entries keep insertion order. Values returned by get()/iteration are views
+// into the arena and stay valid until the map is next modified.
+// ─────────────────────────────────────────────────────────────────────────────
+class HeaderMap {
+public:
+    HeaderMap() { arena_.reserve(512); }
+
+    // Append an entry without checking for duplicates. The hot path: the
+    // response parser calls this once per header line, copying the bytes
+    // straight off the read buffer into the arena.
+    void add(std::string_view name, std::string_view value) {
+        Entry e;
+        e.name_off = static_cast<uint32_t>(arena_.size());
+        e.name_len = static_cast<uint32_t>(name.size());
+        arena_.append(name.data(), name.size());
+        e.value_off = static_cast<uint32_t>(arena_.size());
+        e.value_len = static_cast<uint32_t>(value.size());
+        arena_.append(value.data(), value.size());
+        entries_.push_back(e);
+    }
+
+    // Replace the first entry with this name, or append one. Replacement
+    // writes the new value at the arena tail and abandons the old bytes —
+    // header rewrites are rare enough that compaction isn't worth it.
+    void set(std::string_view name, std::string_view value) {
+        for (auto& e : entries_) {
+            if (iequals(name_of(e), name)) {
+                e.value_off = static_cast<uint32_t>(arena_.size());
+                e.value_len = static_cast<uint32_t>(value.size());
+                arena_.append(value.data(), value.size());
+                return;
+            }
+        }
+        add(name, value);
+    }
+
+    // Case-insensitive lookup of the first matching entry.
+    std::optional<std::string_view> get(std::string_view name) const {
+        for (const auto& e : entries_) {
+            if (iequals(name_of(e), name)) {
+                return value_of(e);
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool contains(std::string_view name) const { return get(name).has_value(); }
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    void clear() {
+        arena_.clear();
+        entries_.clear();
+    }
+
+    // Exact (case-sensitive, order-sensitive) equality — used to decide
+    // whether a cached serialized request template is still valid.
+    bool operator==(const HeaderMap& other) const {
+        if (entries_.size() != other.entries_.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (name_of(entries_[i]) != other.name_of(other.entries_[i]) ||
+                value_of(entries_[i]) != other.value_of(other.entries_[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const HeaderMap& other) const { return !(*this == other); }
+
+    // Forward iteration yielding (name, value) view pairs in insertion order.
+    class const_iterator {
+    public:
+        using value_type = std::pair<std::string_view, std::string_view>;
+
+        const_iterator(const HeaderMap* map, size_t idx) : map_(map), idx_(idx) {}
+
+        value_type operator*() const {
+            const Entry& e = map_->entries_[idx_];
+            return {map_->name_of(e), map_->value_of(e)};
+        }
+        const_iterator& operator++() {
+            ++idx_;
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return idx_ == other.idx_; }
+        bool operator!=(const const_iterator& other) const { return idx_ != other.idx_; }
+
+    private:
+        const HeaderMap* map_;
+        size_t idx_;
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, entries_.size()); }
+
+private:
+    struct Entry {
+        uint32_t name_off;
+        uint32_t name_len;
+        uint32_t value_off;
+        uint32_t value_len;
+    };
+
+    static bool iequals(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if ((a[i] | 0x20) != (b[i] | 0x20)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string_view name_of(const Entry& e) const {
+        return std::string_view(arena_).substr(e.name_off, e.name_len);
+    }
+    std::string_view value_of(const Entry& e) const {
+        return std::string_view(arena_).substr(e.value_off, e.value_len);
+    }
+
+    std::string arena_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace crawl
@@ -2,56 +2,77 @@
 
 #include <string>
 #include <vector>
-#include <map>
 #include <optional>
 #include <chrono>
 #include <memory>
 
+#include "header_map.hpp"
+
 #ifdef HAVE_NGHTTP2
 #include <nghttp2/nghttp2.h>
 #endif
 
 namespace crawl {
 
+class TLSConnection;
+
 struct HTTP2Request {
     std::string method;
     std::string path;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     std::vector<uint8_t> body;
 };
 
 struct HTTP2Response {
     int status_code;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     std::vector<uint8_t> body;
 };
 
 #ifdef HAVE_NGHTTP2
 
+// One HTTP/2 connection, negotiated via ALPN on an established TLS
+// connection. Multiple requests to the same host are multiplexed as
+// concurrent streams over this single session.
 class HTTP2Session {
 public:
-    HTTP2Session(int socket_fd, const std::string& host);
+    HTTP2Session(TLSConnection* tls, const std::string& host);
     ~HTTP2Session();
-    
-    // Initialize HTTP/2 session
+
+    // Initialize HTTP/2 session (sends preface + SETTINGS)
     bool init();
-    
+
     // Send request and get response
     std::optional<HTTP2Response> request(const HTTP2Request& req);
-    
+
     // Send multiple requests (multiplexed)
     std::vector<HTTP2Response> batch_request(const std::vector<HTTP2Request>& requests);
-    
+
     // Check if connection is still alive
     bool is_alive() const;
-    
+
 private:
-    int socket_fd_;
+    TLSConnection* tls_;
     std::string host_;
     nghttp2_session* session_ = nullptr;
-    
-    bool send_connection_header();
+    size_t pending_streams_ = 0;
+    bool alive_ = false;
+
     bool send_settings();
+    bool run_io();
+
+    // nghttp2 callbacks (user_data is the HTTP2Session*)
+    static ssize_t cb_send(nghttp2_session* session, const uint8_t* data,
+                           size_t length, int flags, void* user_data);
+    static int cb_on_header(nghttp2_session* session, const nghttp2_frame* frame,
+                            const uint8_t* name, size_t namelen,
+                            const uint8_t* value, size_t valuelen,
+                            uint8_t flags, void* user_data);
+    static int cb_on_data_chunk(nghttp2_session* session, uint8_t flags,
+                                int32_t stream_id, const uint8_t* data,
+                                size_t len, void* user_data);
+    static int cb_on_stream_close(nghttp2_session* session, int32_t stream_id,
+                                  uint32_t error_code, void* user_data);
 };
 
 #else
@@ -59,7 +80,7 @@ private:
 // Stub implementation when nghttp2 is not available
 class HTTP2Session {
 public:
-    HTTP2Session(int, const std::string&) {}
+    HTTP2Session(TLSConnection*, const std::string&) {}
     bool init() { return false; }
     std::optional<HTTP2Response> request(const HTTP2Request&) { return std::nullopt; }
     std::vector<HTTP2Response> batch_request(const std::vector<HTTP2Request>&) { return {}; }
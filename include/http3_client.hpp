@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+
+#include "header_map.hpp"
+
+namespace crawl {
+
+struct HTTP3Request {
+    std::string method;
+    std::string path;
+    HeaderMap headers;
+    std::vector<uint8_t> body;
+};
+
+struct HTTP3Response {
+    int status_code;
+    HeaderMap headers;
+    std::vector<uint8_t> body;
+};
+
+// One HTTP/3 connection over QUIC — the peer to HTTP2Session
+// (http2_client.hpp). The selection logic in HTTPClient is real today:
+// -3 or a learned Alt-Svc entry routes a request here first, and a failed
+// init() falls back to the TCP stack, exactly as the h2 stub behaves when
+// nghttp2 is absent.
+//
+// The QUIC datapath itself is not wired up yet: ngtcp2 has no mbedTLS
+// crypto adapter, so a real transport first needs a QUIC-capable TLS
+// backend. When that lands it slots in behind HAVE_HTTP3 (mirroring
+// HAVE_NGHTTP2) without touching any caller.
+class HTTP3Session {
+public:
+    HTTP3Session(const std::string&, int) {}
+    bool init() { return false; }
+    std::optional<HTTP3Response> request(const HTTP3Request&) { return std::nullopt; }
+    bool is_alive() const { return false; }
+};
+
+} // namespace crawl
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <optional>
 #include <chrono>
 #include <memory>
 #include <functional>
 #include <atomic> // Added for std::atomic
 
+#include "header_map.hpp"
+
 extern std::atomic<size_t> g_downloaded;
 extern std::atomic<size_t> g_total;
 extern std::atomic<bool> g_progress_thread_running;
@@ -21,32 +23,70 @@ struct URL {
     int port;
     std::string path;
     std::string query;
-    
+
     static std::optional<URL> parse(const std::string& url);
     std::string to_string() const;
 };
 
+// Zero-copy URL parse result: the fields are string_view slices into the
+// caller's buffer, so parsing allocates nothing. Used on hot paths (batch
+// ingestion, redirect following) to validate and inspect a URL before paying
+// for owning copies; the buffer must outlive the view. Call to_url() where
+// the URL has to survive the buffer.
+struct URLView {
+    std::string_view scheme; // as written — compare case-insensitively
+    std::string_view host;
+    int port = 0;
+    std::string_view path;   // "/" when the URL has none
+    std::string_view query;
+
+    static std::optional<URLView> parse(std::string_view url);
+    bool is_https() const;
+    URL to_url() const;      // materialize owning copies (scheme lowercased)
+};
+
+// Streaming body sink: called with body bytes as they arrive off the socket.
+// Return false to abort the transfer. When set, body bytes are handed to the
+// sink and NOT retained in Response::body, so memory stays O(buffer size).
+using BodySink = std::function<bool(const uint8_t* data, size_t len)>;
+
 struct Request {
     std::string method = "GET";
     URL url;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     std::vector<uint8_t> body;
+    // Optional: stream the request body from this file instead of body.
+    // Memory stays constant however large the file is — sendfile on plain
+    // TCP (zero-copy), bounded buffers through TLS. Takes precedence over
+    // body when both are set.
+    std::string body_file;
+    BodySink body_sink; // Optional: stream body instead of buffering it
     std::chrono::milliseconds timeout{30000};
     bool follow_redirects = false;
     int max_redirects = 10;
     bool enable_compression = true;
     bool prefer_http2 = true;
+    bool prefer_http3 = true; // gated by HTTPClient::enable_http3
     
     // Retry settings
     int max_retries = 0;
     std::chrono::milliseconds retry_delay{1000};
     bool exponential_backoff = true;
+
+    // Hedging: if no response arrives within hedge_delay, send a duplicate
+    // request on a second connection and take whichever answers first. The
+    // losing attempt drains in the background and its connection returns to
+    // the pool. A zero delay means "use the observed p95 latency" (1s until
+    // Statistics has enough samples). A fast failure before the delay fires
+    // the duplicate immediately, so it doubles as a sleep-free retry.
+    bool enable_hedging = false;
+    std::chrono::milliseconds hedge_delay{0};
 };
 
 struct Response {
     int status_code;
     std::string status_message;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     std::vector<uint8_t> body;
     std::chrono::milliseconds elapsed_time;
     
@@ -86,12 +126,26 @@ public:
     void set_user_agent(const std::string& ua);
     void set_max_connections(int max);
     void enable_http2(bool enable);
+    void enable_http3(bool enable);
+    // HTTP/1.1 pipelining for batch_request: same-host idempotent requests
+    // are written back-to-back on one connection and their responses read in
+    // order, collapsing per-request round trips. Off by default — some
+    // intermediaries still mishandle pipelined requests; failures fall back
+    // to the normal batch path.
+    void enable_pipelining(bool enable);
     void enable_compression(bool enable);
     void set_rate_limit(double requests_per_second, size_t burst = 0);
+    void set_per_host_rate_limit(double requests_per_second, size_t burst = 0);
     
     // Advanced features
     void enable_dns_cache(bool enable, std::chrono::seconds ttl = std::chrono::seconds(300));
+    void enable_disk_cache(bool enable, const std::string& dir = ".crawl_cache");
     void warmup_dns(const std::vector<std::string>& hosts);
+    // Warm whole connections, not just the resolver: establish n sockets to
+    // host:port — TCP connect plus the full TLS handshake — on background
+    // threads and park them idle in the pool, so the first real request
+    // starts writing bytes immediately. TLS is assumed on any port but 80.
+    void preconnect(const std::string& host, int port, int n = 1);
     
     // Statistics
     Statistics* get_stats();
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "http_client.hpp"
+#include <functional>
+
+namespace crawl {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Incremental HTTP/1.1 response parser
+//   Consumes bytes as they come off the socket in a single pass: status line,
+//   headers, and body framing (Content-Length or chunked) are tracked across
+//   feed() calls, so nothing is buffered for a second parse and nothing is
+//   ever rescanned. Only the current header line is held back between calls;
+//   body bytes flow straight to the body handler (Response::body by default).
+// ─────────────────────────────────────────────────────────────────────────────
+class HTTP1Parser {
+public:
+    enum class Status {
+        NeedMore,  // message incomplete — keep feeding
+        Complete,  // full message parsed
+        Error,     // malformed framing or the body handler aborted
+    };
+
+    HTTP1Parser();
+
+    // Back to a fresh parser (keeps nothing from the previous message)
+    void reset();
+
+    // HEAD responses carry framing headers but no body
+    void set_head_request(bool head);
+
+    // Invoked once, after the status line and headers are parsed and before
+    // any body byte is processed — the hook where callers decide how to
+    // route the body (e.g. install a streaming sink).
+    void set_headers_callback(std::function<void()> cb);
+
+    // Route decoded body bytes somewhere other than response().body.
+    // Return false to abort the transfer.
+    void set_body_handler(BodySink handler);
+
+    // Consume a chunk of wire bytes
+    Status feed(const uint8_t* data, size_t len);
+
+    // The peer closed the connection: completes an unknown-length body,
+    // otherwise reports truncation.
+    Status finish_eof();
+
+    bool headers_complete() const { return headers_complete_; }
+    bool message_complete() const { return state_ == State::Done; }
+    size_t bytes_fed() const { return bytes_fed_; }
+    // Bytes the last feed() actually consumed — less than its len when the
+    // message completed mid-buffer (pipelined responses share the stream)
+    size_t last_feed_consumed() const { return last_consumed_; }
+    size_t body_bytes() const { return body_received_; } // decoded transfer bytes
+
+    const Response& response() const { return resp_; }
+    Response take_response() { return std::move(resp_); }
+
+private:
+    enum class State {
+        StatusLine,
+        Headers,
+        FixedBody,    // Content-Length framing
+        EofBody,      // no framing — body ends when the connection closes
+        ChunkSize,
+        ChunkExt,
+        ChunkData,
+        ChunkDataCr,
+        ChunkDataLf,
+        Trailer,
+        Done,
+        Error,
+    };
+
+    State state_ = State::StatusLine;
+    Response resp_;
+    std::string line_;              // current incomplete status/header line
+    std::function<void()> headers_cb_;
+    BodySink body_handler_;
+
+    bool head_request_ = false;
+    bool headers_complete_ = false;
+    bool chunked_ = false;
+    bool has_content_length_ = false;
+    size_t content_length_ = 0;
+    size_t body_received_ = 0;
+    size_t bytes_fed_ = 0;
+    size_t last_consumed_ = 0;
+
+    size_t chunk_remaining_ = 0;    // bytes left in the current chunk
+    size_t trailer_line_len_ = 0;
+
+    void parse_status_line();
+    bool parse_header_line();
+    void on_headers_end();
+    bool deliver(const uint8_t* data, size_t len);
+};
+
+} // namespace crawl
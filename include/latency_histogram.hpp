@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+namespace crawl {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// HDR-style latency histogram
+//   Log-linear bucketing: values below 64 are recorded exactly, above that
+//   each power-of-two octave is split into 32 linear sub-buckets, bounding
+//   relative error at ~3% across the full 64-bit range. Recording is a couple
+//   of shifts and an increment — cheap enough for per-request hot paths —
+//   and percentiles fall out of a single walk over ~2K counters. Unlike a
+//   sorted-sample approach, memory is fixed regardless of request count.
+//   Values are unitless; callers record microseconds by convention.
+// ─────────────────────────────────────────────────────────────────────────────
+class LatencyHistogram {
+public:
+    void record(uint64_t value) {
+        counts_[bucket_index(value)]++;
+        count_++;
+        sum_ += value;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+    }
+
+    // Value at percentile p (0..100), from the upper edge of the bucket that
+    // crosses the target rank — biased high, never under-reports tails
+    uint64_t percentile(double p) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t target = (uint64_t)(p / 100.0 * (double)count_ + 0.5);
+        if (target < 1) target = 1;
+        if (target > count_) target = count_;
+
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            cumulative += counts_[i];
+            if (cumulative >= target) {
+                uint64_t high = bucket_upper(i);
+                return high > max_ ? max_ : high;
+            }
+        }
+        return max_;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        if (other.count_ > 0) {
+            if (other.min_ < min_) min_ = other.min_;
+            if (other.max_ > max_) max_ = other.max_;
+        }
+    }
+
+    void reset() {
+        counts_.fill(0);
+        count_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? (double)sum_ / (double)count_ : 0.0; }
+
+private:
+    static constexpr int SUB_BITS = 6;          // values < 64 are exact
+    static constexpr int SUB_HALF = 1 << (SUB_BITS - 1); // 32 sub-buckets/octave
+    static constexpr size_t NUM_BUCKETS =
+        (1 << SUB_BITS) + (size_t)(64 - SUB_BITS) * SUB_HALF;
+
+    static size_t bucket_index(uint64_t v) {
+        if (v < (1ull << SUB_BITS)) {
+            return (size_t)v;
+        }
+        int msb = 63 - __builtin_clzll(v);
+        size_t octave = (size_t)(msb - SUB_BITS + 1);
+        size_t sub = (size_t)((v - (1ull << msb)) >> (msb - SUB_BITS + 1));
+        return (1 << SUB_BITS) + (octave - 1) * SUB_HALF + sub;
+    }
+
+    // Largest value that maps to bucket i (inclusive)
+    static uint64_t bucket_upper(size_t i) {
+        if (i < (1 << SUB_BITS)) {
+            return (uint64_t)i;
+        }
+        size_t rel = i - (1 << SUB_BITS);
+        int msb = (int)(rel / SUB_HALF) + SUB_BITS;
+        size_t sub = rel % SUB_HALF;
+        uint64_t width = 1ull << (msb - SUB_BITS + 1);
+        return (1ull << msb) + (uint64_t)(sub + 1) * width - 1;
+    }
+
+    std::array<uint64_t, NUM_BUCKETS> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+} // namespace crawl
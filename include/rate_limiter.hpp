@@ -1,39 +1,77 @@
 #pragma once
 
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <deque>
+#include <string>
+#include <unordered_map>
 
 namespace crawl {
 
+// ─────────────────────────────────────────────────────────────────────────────
+// Lock-free token bucket
+//   The whole bucket is one atomic word: the steady-clock time (ns) at which
+//   the next token becomes free. A thread claims a token by CAS-ing the word
+//   forward one refill interval; accumulated burst capacity is expressed by
+//   never letting the word lag more than burst×interval behind now. No mutex
+//   and no allocation on the request path — contention costs a CAS retry, not
+//   a serialized critical section.
+// ─────────────────────────────────────────────────────────────────────────────
 class RateLimiter {
 public:
     // requests_per_second: max requests per second (0 = unlimited)
-    // burst: max burst size
+    // burst: max burst size (0 = one second's worth)
     RateLimiter(double requests_per_second = 0, size_t burst = 0);
-    
+
     // Wait until a request can be made (respecting rate limit)
     void acquire();
-    
+
     // Try to acquire without blocking
     bool try_acquire();
-    
+
     // Update rate limit
     void set_rate(double requests_per_second, size_t burst = 0);
-    
+
     // Get current rate
+    double get_rate() const { return rate_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> rate_{0};
+    std::atomic<int64_t> interval_ns_{0}; // ns between tokens
+    std::atomic<int64_t> burst_ns_{0};    // how far next_free may lag now
+    std::atomic<int64_t> next_free_ns_{0};
+
+    static int64_t now_ns();
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Per-origin rate limiting
+//   Politeness caps are per host, not global: one slow origin must not
+//   throttle the other five hundred in a batch. One lock-free bucket per
+//   host, created on first sight; the map mutex guards only bucket lookup
+//   and creation — all waiting happens on the bucket itself.
+// ─────────────────────────────────────────────────────────────────────────────
+class PerHostRateLimiter {
+public:
+    PerHostRateLimiter(double requests_per_second = 0, size_t burst = 0);
+
+    void acquire(const std::string& host);
+    bool try_acquire(const std::string& host);
+
+    // Applies to existing buckets and any created later
+    void set_rate(double requests_per_second, size_t burst = 0);
+
     double get_rate() const { return rate_; }
-    
+
 private:
-    double rate_;  // requests per second
-    size_t burst_; // max burst size
-    std::chrono::nanoseconds interval_;
-    
-    std::mutex mutex_;
-    std::deque<std::chrono::steady_clock::time_point> tokens_;
-    std::chrono::steady_clock::time_point last_refill_;
-    
-    void refill();
+    std::shared_ptr<RateLimiter> bucket_for(const std::string& host);
+
+    double rate_;
+    size_t burst_;
+    std::mutex map_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<RateLimiter>> buckets_;
 };
 
 } // namespace crawl
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace crawl {
+namespace simd {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Vectorized scan primitives for the HTTP parser hot loops
+//   memchr-style delimiter search and hex-run classification moving 16 bytes
+//   (SSE2) or 32 bytes (AVX2) per iteration, with a scalar fallback so the
+//   code stays portable. The build's -march=native picks the widest path.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Index of the first occurrence of `c` in data[0..len), or `len` if absent
+inline size_t find_byte(const uint8_t* data, size_t len, uint8_t c) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i needle32 = _mm256_set1_epi8(static_cast<char>(c));
+    for (; i + 32 <= len; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle32)));
+        if (mask) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i needle16 = _mm_set1_epi8(static_cast<char>(c));
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle16)));
+        if (mask) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+#endif
+
+    for (; i < len; ++i) {
+        if (data[i] == c) {
+            return i;
+        }
+    }
+    return len;
+}
+
+// Length of the leading run of hex digits ([0-9a-fA-F]) in data[0..len)
+inline size_t hex_span(const uint8_t* data, size_t len) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // ASCII is < 0x80, so signed byte compares are safe range checks
+    const __m128i zero_m1  = _mm_set1_epi8('0' - 1);
+    const __m128i nine_p1  = _mm_set1_epi8('9' + 1);
+    const __m128i a_m1     = _mm_set1_epi8('a' - 1);
+    const __m128i f_p1     = _mm_set1_epi8('f' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i lower = _mm_or_si128(v, case_bit); // fold A-F onto a-f
+
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, zero_m1),
+                                      _mm_cmplt_epi8(v, nine_p1));
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, a_m1),
+                                      _mm_cmplt_epi8(lower, f_p1));
+
+        uint32_t hex_mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+        uint32_t non_hex = ~hex_mask & 0xFFFFu;
+        if (non_hex) {
+            return i + static_cast<size_t>(__builtin_ctz(non_hex));
+        }
+    }
+#endif
+
+    for (; i < len; ++i) {
+        uint8_t c = data[i];
+        bool hex = (c >= '0' && c <= '9') ||
+                   ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+        if (!hex) {
+            return i;
+        }
+    }
+    return len;
+}
+
+} // namespace simd
+} // namespace crawl
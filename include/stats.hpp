@@ -4,7 +4,12 @@
 #include <atomic>
 #include <string>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "latency_histogram.hpp"
 
 namespace crawl {
 
@@ -12,11 +17,17 @@ class Statistics {
 public:
     Statistics();
     
-    // Request tracking
-    void record_request(std::chrono::milliseconds latency, size_t bytes_received);
+    // Request tracking. Pass the origin host to also feed its per-host
+    // distribution — that's what surfaces one slow origin in a mixed batch
+    // instead of averaging it away across fifty fast ones.
+    void record_request(std::chrono::milliseconds latency, size_t bytes_received,
+                        const std::string& host = std::string());
     void record_connection(bool reused);
     void record_error(const std::string& error_type);
     
+    // Protocol tracking ("http/1.1", "h2" or "h3")
+    void record_protocol(const std::string& proto);
+
     // DNS tracking
     void record_dns_lookup(std::chrono::milliseconds duration, bool cached);
     
@@ -38,6 +49,10 @@ public:
         
         uint64_t connections_created;
         uint64_t connections_reused;
+
+        uint64_t http1_requests;
+        uint64_t http2_requests;
+        uint64_t http3_requests;
         
         uint64_t dns_lookups;
         uint64_t dns_cache_hits;
@@ -45,7 +60,20 @@ public:
         double avg_latency_ms;
         double min_latency_ms;
         double max_latency_ms;
-        
+        double p50_latency_ms;
+        double p95_latency_ms;
+        double p99_latency_ms;
+
+        // Slowest origins by p95, descending — the hosts worth paging on
+        struct HostLatency {
+            std::string host;
+            uint64_t requests;
+            double p50_ms;
+            double p95_ms;
+            double p99_ms;
+        };
+        std::vector<HostLatency> slowest_hosts;
+
         double avg_dns_ms;
         double avg_tcp_handshake_ms;
         double avg_first_byte_ms;
@@ -58,6 +86,11 @@ public:
         std::map<std::string, uint64_t> error_counts;
     };
     
+    // Latency distribution percentile (p in (0, 1], e.g. 0.95). Returns 0ms
+    // until enough samples exist to make the estimate meaningful — callers
+    // using it as a threshold should fall back to a fixed default then.
+    std::chrono::milliseconds latency_percentile(double p) const;
+
     Stats get_stats() const;
     void reset();
     
@@ -72,6 +105,10 @@ private:
     
     std::atomic<uint64_t> connections_created_{0};
     std::atomic<uint64_t> connections_reused_{0};
+
+    std::atomic<uint64_t> http1_requests_{0};
+    std::atomic<uint64_t> http2_requests_{0};
+    std::atomic<uint64_t> http3_requests_{0};
     
     std::atomic<uint64_t> dns_lookups_{0};
     std::atomic<uint64_t> dns_cache_hits_{0};
@@ -94,7 +131,22 @@ private:
     
     mutable std::mutex error_mutex_;
     std::map<std::string, uint64_t> error_counts_;
-    
+
+    // Full latency distribution (ms), for percentile queries
+    mutable std::mutex hist_mutex_;
+    LatencyHistogram latency_hist_;
+
+    // Per-host distributions, sharded like PerHostRateLimiter: the map
+    // mutex covers only lookup/creation, so recording contends only with
+    // requests to the same host. Aggregated (sorted, percentiled) solely at
+    // get_stats()/print() time.
+    struct HostHist {
+        std::mutex mutex;
+        LatencyHistogram hist;
+    };
+    mutable std::mutex host_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<HostHist>> host_hists_;
+
     // Helper to print aligned line
     void print_line(const std::string& label, const std::string& value, int total_width = 64) const;
 };
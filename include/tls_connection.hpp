@@ -7,24 +7,52 @@
 
 namespace crawl {
 
+// Single step result for the non-blocking handshake used by the async engine
+enum class TLSHandshakeStatus {
+    Done,
+    WantRead,
+    WantWrite,
+    Error
+};
+
 class TLSConnection {
 public:
     TLSConnection(int socket_fd, const std::string& hostname);
     ~TLSConnection();
-    
+
     bool handshake();
+
+    // Drive the handshake one step at a time on a non-blocking socket.
+    // Call again when the socket is readable/writable as indicated.
+    TLSHandshakeStatus handshake_step();
+
+    // Offer "h2" via ALPN during the handshake (call before handshake())
+    void enable_alpn_http2();
+
+    // True when the server selected HTTP/2 via ALPN
+    bool negotiated_http2() const;
+
     ssize_t send(const void* data, size_t len);
+
+    // Single write attempt for non-blocking sockets:
+    // returns bytes written (>0), 0 if it would block, -1 on error
+    ssize_t send_nonblocking(const void* data, size_t len);
+
     ssize_t recv(void* data, size_t len);
     void close();
-    
+
     bool is_connected() const { return connected_; }
-    
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
     int socket_fd_;
     std::string hostname_;
     bool connected_;
+    bool setup_done_ = false;
+    bool want_http2_ = false;
+
+    bool setup_context();
 };
 
 } // namespace crawl
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace crawl {
+namespace trace {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Request lifecycle tracing — Chrome trace-event output
+//
+// Statistics answers "what does the average request look like"; this answers
+// "which phase of which request stalled". When enabled, each instrumented
+// phase (dns, connect, tls, send, ttfb, body, decompress, queue) records one
+// complete event into a fixed-size per-thread ring buffer — no locks, no
+// allocation on the hot path, oldest events overwritten on wrap. write()
+// dumps everything as Chrome trace-event JSON ("ph":"X"), loadable in
+// chrome://tracing or Perfetto.
+//
+// Disabled (the default) the cost per span is one relaxed atomic load, so
+// the instrumentation can stay in the request path unconditionally.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Turn recording on; call once before the run being investigated.
+void enable();
+bool enabled();
+
+// Microseconds on the steady clock — the timebase for all events.
+uint64_t now_us();
+
+// Record a complete event [start_us, end_us) on the calling thread's buffer.
+// `name` must be a string literal (stored by pointer, never copied).
+void emit(const char* name, uint64_t start_us, uint64_t end_us);
+
+// Dump every thread's events as trace-event JSON. Returns false on I/O error.
+bool write(const std::string& path);
+
+// RAII span: times its own scope. A span constructed while tracing is
+// disabled records nothing and costs nothing on destruction.
+class Span {
+public:
+    explicit Span(const char* name) {
+        if (enabled()) {
+            name_ = name;
+            start_ = now_us();
+        }
+    }
+    ~Span() {
+        if (name_) {
+            emit(name_, start_, now_us());
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_ = nullptr;
+    uint64_t start_ = 0;
+};
+
+} // namespace trace
+} // namespace crawl
@@ -0,0 +1,201 @@
+#include "async_writer.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+namespace crawl {
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path, size_t preallocate,
+                                 bool truncate) {
+    int flags = O_CREAT | O_WRONLY | (truncate ? O_TRUNC : 0);
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        return;
+    }
+
+    if (preallocate > 0) {
+        // ftruncate covers filesystems without real preallocation
+        if (posix_fallocate(fd_, 0, (off_t)preallocate) != 0 &&
+            ftruncate(fd_, (off_t)preallocate) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+    }
+
+    thread_ = std::thread([this]() { run(); });
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    finish();
+}
+
+bool AsyncFileWriter::write(size_t offset, const uint8_t* data, size_t len) {
+    if (fd_ < 0 || len == 0) {
+        return fd_ >= 0;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (failed_) {
+        return false; // disk already broke; stop the download early
+    }
+    can_push_.wait(lock, [&]() {
+        return failed_ || queued_bytes_ + len <= MAX_QUEUED_BYTES;
+    });
+    if (failed_) {
+        return false;
+    }
+
+    queue_.push_back({offset, std::vector<uint8_t>(data, data + len)});
+    queued_bytes_ += len;
+    can_pop_.notify_one();
+    return true;
+}
+
+bool AsyncFileWriter::finish() {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+        can_pop_.notify_one();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    bool ok = !failed_ && ::fdatasync(fd_) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    return ok;
+}
+
+void AsyncFileWriter::run() {
+    std::deque<Chunk> batch;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            can_pop_.wait(lock, [&]() { return closing_ || !queue_.empty(); });
+            if (queue_.empty() && closing_) {
+                return;
+            }
+            batch.swap(queue_); // take everything queued in one go
+        }
+
+        bool ok = write_batch(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const Chunk& c : batch) {
+                queued_bytes_ -= c.data.size();
+            }
+            if (!ok) {
+                failed_ = true;
+            }
+            can_push_.notify_all();
+            if (failed_) {
+                // Unblock any producer, then keep consuming so finish() ends
+                can_pop_.notify_all();
+            }
+        }
+        batch.clear();
+    }
+}
+
+bool AsyncFileWriter::pwrite_full(const Chunk& chunk) {
+    const uint8_t* p = chunk.data.data();
+    size_t remaining = chunk.data.size();
+    size_t off = chunk.offset;
+    while (remaining > 0) {
+        ssize_t w = ::pwrite(fd_, p, remaining, (off_t)off);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        off += (size_t)w;
+        remaining -= (size_t)w;
+    }
+    return true;
+}
+
+#ifdef HAVE_LIBURING
+
+// Submit the whole batch as positional writes on a ring and reap the
+// completions; a short write is re-submitted as a plain pwrite (rare)
+bool AsyncFileWriter::write_batch(std::deque<Chunk>& batch) {
+    static constexpr unsigned QUEUE_DEPTH = 64;
+
+    struct io_uring ring;
+    if (io_uring_queue_init(QUEUE_DEPTH, &ring, 0) != 0) {
+        for (const Chunk& c : batch) {
+            if (!pwrite_full(c)) return false;
+        }
+        return true;
+    }
+
+    bool ok = true;
+    size_t next = 0;
+    unsigned inflight = 0;
+
+    while ((next < batch.size() || inflight > 0) && ok) {
+        while (next < batch.size() && inflight < QUEUE_DEPTH) {
+            struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            if (!sqe) break;
+            const Chunk& c = batch[next];
+            io_uring_prep_write(sqe, fd_, c.data.data(), c.data.size(),
+                                (off_t)c.offset);
+            io_uring_sqe_set_data(sqe, (void*)(uintptr_t)next);
+            next++;
+            inflight++;
+        }
+        io_uring_submit(&ring);
+
+        struct io_uring_cqe* cqe = nullptr;
+        if (io_uring_wait_cqe(&ring, &cqe) != 0) {
+            ok = false;
+            break;
+        }
+        size_t idx = (size_t)(uintptr_t)io_uring_cqe_get_data(cqe);
+        ssize_t res = cqe->res;
+        io_uring_cqe_seen(&ring, cqe);
+        inflight--;
+
+        if (res < 0) {
+            ok = false;
+        } else if ((size_t)res < batch[idx].data.size()) {
+            // Short write: finish this chunk synchronously
+            Chunk rest;
+            rest.offset = batch[idx].offset + (size_t)res;
+            rest.data.assign(batch[idx].data.begin() + res,
+                             batch[idx].data.end());
+            if (!pwrite_full(rest)) ok = false;
+        }
+    }
+
+    io_uring_queue_exit(&ring);
+    return ok;
+}
+
+#else
+
+bool AsyncFileWriter::write_batch(std::deque<Chunk>& batch) {
+    for (const Chunk& c : batch) {
+        if (!pwrite_full(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
+
+} // namespace crawl
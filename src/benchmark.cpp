@@ -1,100 +1,341 @@
 #include "http_client.hpp"
+#include "latency_histogram.hpp"
 #include "stats.hpp"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
+#include <string>
 #include <vector>
 #include <thread>
+#include <atomic>
+#include <cstdlib>
 
 using namespace crawl;
+using Clock = std::chrono::steady_clock;
 
-void run_benchmark(const std::string& url, int num_requests, int concurrency) {
-    std::cout << "\n=== Crawl Benchmark ===\n";
-    std::cout << "URL:         " << url << "\n";
-    std::cout << "Requests:    " << num_requests << "\n";
-    std::cout << "Concurrency: " << concurrency << "\n";
-    std::cout << "\n";
-    
-    HTTPClient client;
-    client.enable_dns_cache(true);
-    client.set_max_connections(concurrency * 2);
-    
-    // Warmup
-    std::cout << "Warming up...\n";
-    auto parsed_url = URL::parse(url);
-    if (!parsed_url) {
-        std::cerr << "Error: Invalid URL\n";
-        return;
+namespace {
+
+struct BenchConfig {
+    std::string url;
+    int num_requests = 100;       // closed-loop, count mode
+    int concurrency = 10;
+    double duration_sec = 0;      // > 0: run for a fixed time instead
+    double rate = 0;              // > 0: open-loop, fixed requests/sec
+    std::string format;           // "", "json" or "csv"
+};
+
+struct BenchResult {
+    LatencyHistogram hist;        // microseconds
+    uint64_t success = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    double wall_sec = 0;
+};
+
+// One histogram per worker, merged at the end — no shared state on the
+// request path
+struct WorkerState {
+    LatencyHistogram hist;
+    uint64_t success = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+void record_response(WorkerState& w, const Response& resp, uint64_t latency_us) {
+    w.hist.record(latency_us);
+    if (resp.status_code >= 200 && resp.status_code < 400) {
+        w.success++;
+        w.bytes += resp.bytes_received;
+    } else {
+        w.errors++;
     }
-    
-    client.warmup_dns({parsed_url->host});
-    
-    // Run benchmark
-    std::cout << "Running benchmark...\n";
-    auto start = std::chrono::steady_clock::now();
-    
-    std::vector<Request> requests;
-    for (int i = 0; i < num_requests; ++i) {
-        Request req;
-        req.method = "GET";
-        req.url = *parsed_url;
-        req.timeout = std::chrono::seconds(30);
-        req.follow_redirects = true;
-        requests.push_back(req);
+}
+
+// Closed-loop: each worker issues its next request as soon as the previous
+// one completes. Measures service latency under `concurrency` in flight.
+BenchResult run_closed_loop(HTTPClient& client, const URL& url,
+                            const BenchConfig& cfg) {
+    std::vector<WorkerState> workers(cfg.concurrency);
+    std::atomic<long> issued{0};
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(cfg.duration_sec));
+    bool duration_mode = cfg.duration_sec > 0;
+
+    std::vector<std::thread> threads;
+    threads.reserve(cfg.concurrency);
+    for (int i = 0; i < cfg.concurrency; ++i) {
+        threads.emplace_back([&, i]() {
+            WorkerState& w = workers[i];
+            Request req;
+            req.method = "GET";
+            req.url = url;
+            req.timeout = std::chrono::seconds(30);
+            req.follow_redirects = true;
+
+            while (true) {
+                if (duration_mode) {
+                    if (Clock::now() >= deadline) break;
+                } else {
+                    if (issued.fetch_add(1) >= cfg.num_requests) break;
+                }
+                auto t0 = Clock::now();
+                Response resp = client.request(req);
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - t0).count();
+                record_response(w, resp, (uint64_t)us);
+            }
+        });
     }
-    
-    auto responses = client.batch_request(requests, concurrency);
-    
-    auto end = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    
-    // Calculate statistics
-    int success = 0;
-    int errors = 0;
-    size_t total_bytes = 0;
-    double total_latency = 0;
-    
-    for (const auto& resp : responses) {
-        if (resp.status_code >= 200 && resp.status_code < 400) {
-            success++;
-            total_bytes += resp.bytes_received;
-            total_latency += resp.elapsed_time.count();
-        } else {
-            errors++;
-        }
+    for (auto& t : threads) t.join();
+
+    BenchResult result;
+    result.wall_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& w : workers) {
+        result.hist.merge(w.hist);
+        result.success += w.success;
+        result.errors += w.errors;
+        result.bytes += w.bytes;
+    }
+    return result;
+}
+
+// Open-loop: requests are issued on a fixed schedule (ticket k fires at
+// start + k/rate) regardless of how long earlier ones take, and latency is
+// measured from the *intended* send time. When the target rate exceeds what
+// the server sustains, queueing delay shows up in the tail instead of being
+// silently absorbed by a stalled sender (coordinated omission).
+BenchResult run_open_loop(HTTPClient& client, const URL& url,
+                          const BenchConfig& cfg) {
+    std::vector<WorkerState> workers(cfg.concurrency);
+    std::atomic<long> next_ticket{0};
+
+    double duration_sec = cfg.duration_sec > 0 ? cfg.duration_sec : 10.0;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(duration_sec));
+
+    std::vector<std::thread> threads;
+    threads.reserve(cfg.concurrency);
+    for (int i = 0; i < cfg.concurrency; ++i) {
+        threads.emplace_back([&, i]() {
+            WorkerState& w = workers[i];
+            Request req;
+            req.method = "GET";
+            req.url = url;
+            req.timeout = std::chrono::seconds(30);
+            req.follow_redirects = true;
+
+            while (true) {
+                long k = next_ticket.fetch_add(1);
+                auto intended = start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>((double)k / cfg.rate));
+                if (intended >= deadline) break;
+
+                std::this_thread::sleep_until(intended);
+                Response resp = client.request(req);
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - intended).count();
+                record_response(w, resp, (uint64_t)us);
+            }
+        });
     }
-    
-    double duration_sec = duration.count() / 1000.0;
-    double rps = num_requests / duration_sec;
-    double avg_latency = total_latency / num_requests;
-    double throughput_mbps = (total_bytes / duration_sec) / (1024 * 1024);
-    
+    for (auto& t : threads) t.join();
+
+    BenchResult result;
+    result.wall_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& w : workers) {
+        result.hist.merge(w.hist);
+        result.success += w.success;
+        result.errors += w.errors;
+        result.bytes += w.bytes;
+    }
+    return result;
+}
+
+void print_human(const BenchConfig& cfg, const BenchResult& r) {
+    uint64_t total = r.success + r.errors;
+    double rps = total / r.wall_sec;
+    double throughput_mbps = (r.bytes / r.wall_sec) / (1024 * 1024);
+
     std::cout << "\n=== Results ===\n";
     std::cout << std::fixed << std::setprecision(2);
-    std::cout << "Total time:       " << duration_sec << " seconds\n";
+    std::cout << "Total time:       " << r.wall_sec << " seconds\n";
+    std::cout << "Requests:         " << total << "\n";
     std::cout << "Requests/sec:     " << rps << "\n";
-    std::cout << "Avg latency:      " << avg_latency << " ms\n";
-    std::cout << "Success:          " << success << " (" << (success * 100.0 / num_requests) << "%)\n";
-    std::cout << "Errors:           " << errors << "\n";
-    std::cout << "Total data:       " << (total_bytes / (1024.0 * 1024.0)) << " MB\n";
+    std::cout << "Success:          " << r.success
+              << " (" << (total ? r.success * 100.0 / total : 0.0) << "%)\n";
+    std::cout << "Errors:           " << r.errors << "\n";
+    std::cout << "Total data:       " << (r.bytes / (1024.0 * 1024.0)) << " MB\n";
     std::cout << "Throughput:       " << throughput_mbps << " MB/s\n";
+
+    std::cout << "\n=== Latency (ms) ===\n";
+    std::cout << "Min:              " << r.hist.min() / 1000.0 << "\n";
+    std::cout << "Mean:             " << r.hist.mean() / 1000.0 << "\n";
+    std::cout << "p50:              " << r.hist.percentile(50) / 1000.0 << "\n";
+    std::cout << "p90:              " << r.hist.percentile(90) / 1000.0 << "\n";
+    std::cout << "p99:              " << r.hist.percentile(99) / 1000.0 << "\n";
+    std::cout << "p99.9:            " << r.hist.percentile(99.9) / 1000.0 << "\n";
+    std::cout << "Max:              " << r.hist.max() / 1000.0 << "\n";
     std::cout << "\n";
-    
-    client.get_stats()->print(false);
 }
 
+void print_json(const BenchConfig& cfg, const BenchResult& r) {
+    uint64_t total = r.success + r.errors;
+    std::cout << std::fixed << std::setprecision(3)
+              << "{"
+              << "\"url\":\"" << cfg.url << "\","
+              << "\"mode\":\"" << (cfg.rate > 0 ? "open" : "closed") << "\","
+              << "\"concurrency\":" << cfg.concurrency << ","
+              << "\"rate\":" << cfg.rate << ","
+              << "\"duration_sec\":" << r.wall_sec << ","
+              << "\"requests\":" << total << ","
+              << "\"success\":" << r.success << ","
+              << "\"errors\":" << r.errors << ","
+              << "\"bytes\":" << r.bytes << ","
+              << "\"rps\":" << (total / r.wall_sec) << ","
+              << "\"latency_us\":{"
+              << "\"min\":" << r.hist.min() << ","
+              << "\"mean\":" << r.hist.mean() << ","
+              << "\"p50\":" << r.hist.percentile(50) << ","
+              << "\"p90\":" << r.hist.percentile(90) << ","
+              << "\"p99\":" << r.hist.percentile(99) << ","
+              << "\"p999\":" << r.hist.percentile(99.9) << ","
+              << "\"max\":" << r.hist.max()
+              << "}}\n";
+}
+
+void print_csv(const BenchConfig& cfg, const BenchResult& r) {
+    uint64_t total = r.success + r.errors;
+    std::cout << "url,mode,concurrency,rate,duration_sec,requests,success,errors,"
+                 "bytes,rps,min_us,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+    std::cout << std::fixed << std::setprecision(3)
+              << cfg.url << ","
+              << (cfg.rate > 0 ? "open" : "closed") << ","
+              << cfg.concurrency << ","
+              << cfg.rate << ","
+              << r.wall_sec << ","
+              << total << ","
+              << r.success << ","
+              << r.errors << ","
+              << r.bytes << ","
+              << (total / r.wall_sec) << ","
+              << r.hist.min() << ","
+              << r.hist.mean() << ","
+              << r.hist.percentile(50) << ","
+              << r.hist.percentile(90) << ","
+              << r.hist.percentile(99) << ","
+              << r.hist.percentile(99.9) << ","
+              << r.hist.max() << "\n";
+}
+
+void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " <URL> [options]\n"
+              << "       " << prog << " <URL> [requests] [concurrency]   (legacy)\n"
+              << "\n"
+              << "Options:\n"
+              << "  -n, --requests <N>     Number of requests (default 100)\n"
+              << "  -c, --concurrency <N>  Concurrent workers (default 10)\n"
+              << "  -d, --duration <sec>   Run for a fixed time instead of a count\n"
+              << "  -r, --rate <rps>       Open-loop: issue at a fixed rate;\n"
+              << "                         latency includes queueing delay\n"
+              << "      --json             Machine-readable JSON result on stdout\n"
+              << "      --csv              Machine-readable CSV result on stdout\n"
+              << "\n"
+              << "Example: " << prog << " https://example.com -d 30 -r 500 -c 50 --json\n";
+}
+
+} // anonymous namespace
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cout << "Usage: " << argv[0] << " <URL> [requests] [concurrency]\n";
-        std::cout << "Example: " << argv[0] << " https://example.com 1000 10\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    BenchConfig cfg;
+    cfg.url = argv[1];
+
+    int positional = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            return (i + 1 < argc) ? argv[++i] : nullptr;
+        };
+
+        if (arg == "-n" || arg == "--requests") {
+            if (const char* v = next()) cfg.num_requests = std::atoi(v);
+        } else if (arg == "-c" || arg == "--concurrency") {
+            if (const char* v = next()) cfg.concurrency = std::atoi(v);
+        } else if (arg == "-d" || arg == "--duration") {
+            if (const char* v = next()) cfg.duration_sec = std::atof(v);
+        } else if (arg == "-r" || arg == "--rate") {
+            if (const char* v = next()) cfg.rate = std::atof(v);
+        } else if (arg == "--json") {
+            cfg.format = "json";
+        } else if (arg == "--csv") {
+            cfg.format = "csv";
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] != '-') {
+            // Legacy positional form: <URL> [requests] [concurrency]
+            if (positional == 0) cfg.num_requests = std::atoi(arg.c_str());
+            else if (positional == 1) cfg.concurrency = std::atoi(arg.c_str());
+            positional++;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (cfg.concurrency < 1) cfg.concurrency = 1;
+
+    auto parsed_url = URL::parse(cfg.url);
+    if (!parsed_url) {
+        std::cerr << "Error: Invalid URL\n";
         return 1;
     }
-    
-    std::string url = argv[1];
-    int requests = (argc > 2) ? std::atoi(argv[2]) : 100;
-    int concurrency = (argc > 3) ? std::atoi(argv[3]) : 10;
-    
-    run_benchmark(url, requests, concurrency);
-    
+
+    bool quiet = !cfg.format.empty(); // keep stdout clean for CI diffing
+
+    if (!quiet) {
+        std::cout << "\n=== Crawl Benchmark ===\n";
+        std::cout << "URL:         " << cfg.url << "\n";
+        if (cfg.duration_sec > 0 || cfg.rate > 0) {
+            std::cout << "Duration:    "
+                      << (cfg.duration_sec > 0 ? cfg.duration_sec : 10.0) << "s\n";
+        } else {
+            std::cout << "Requests:    " << cfg.num_requests << "\n";
+        }
+        if (cfg.rate > 0) {
+            std::cout << "Rate:        " << cfg.rate << " req/s (open loop)\n";
+        }
+        std::cout << "Concurrency: " << cfg.concurrency << "\n";
+        std::cout << "\n";
+    }
+
+    HTTPClient client;
+    client.enable_dns_cache(true);
+    client.set_max_connections(cfg.concurrency * 2);
+    client.warmup_dns({parsed_url->host});
+
+    if (!quiet) {
+        std::cout << "Running benchmark...\n";
+    }
+
+    BenchResult result = (cfg.rate > 0)
+        ? run_open_loop(client, *parsed_url, cfg)
+        : run_closed_loop(client, *parsed_url, cfg);
+
+    if (cfg.format == "json") {
+        print_json(cfg, result);
+    } else if (cfg.format == "csv") {
+        print_csv(cfg, result);
+    } else {
+        print_human(cfg, result);
+        client.get_stats()->print(false);
+    }
+
     return 0;
 }
@@ -239,18 +239,18 @@ std::optional<std::vector<uint8_t>> Compression::compress(
     const std::vector<uint8_t>& data,
     CompressionType type,
     int level) {
-    
+
     switch (type) {
 #ifdef HAVE_ZLIB
         case CompressionType::Gzip:
             return compress_gzip(data, level);
 #endif
-            
+
 #ifdef HAVE_BROTLI
         case CompressionType::Brotli:
             return compress_brotli(data, level);
 #endif
-            
+
         case CompressionType::None:
         case CompressionType::Deflate:
         default:
@@ -258,4 +258,164 @@ std::optional<std::vector<uint8_t>> Compression::compress(
     }
 }
 
+// ─── StreamingDecompressor ──────────────────────────────────────────────────
+
+class StreamingDecompressor::Impl {
+public:
+    explicit Impl(CompressionType type) : type_(type) {
+        switch (type_) {
+#ifdef HAVE_ZLIB
+            case CompressionType::Gzip:
+                // 15 + 16 for gzip format
+                valid_ = inflateInit2(&zstream_, 15 + 16) == Z_OK;
+                z_active_ = valid_;
+                break;
+            case CompressionType::Deflate:
+                valid_ = inflateInit2(&zstream_, -15) == Z_OK;
+                z_active_ = valid_;
+                break;
+#endif
+#ifdef HAVE_BROTLI
+            case CompressionType::Brotli:
+                brotli_ = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+                valid_ = brotli_ != nullptr;
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+
+    ~Impl() {
+#ifdef HAVE_ZLIB
+        if (z_active_) {
+            inflateEnd(&zstream_);
+        }
+#endif
+#ifdef HAVE_BROTLI
+        if (brotli_) {
+            BrotliDecoderDestroyInstance(brotli_);
+        }
+#endif
+    }
+
+    bool feed(const uint8_t* data, size_t len, const OutputFn& out) {
+        if (!valid_) return false;
+
+        switch (type_) {
+#ifdef HAVE_ZLIB
+            case CompressionType::Gzip:
+            case CompressionType::Deflate:
+                return feed_zlib(data, len, out);
+#endif
+#ifdef HAVE_BROTLI
+            case CompressionType::Brotli:
+                return feed_brotli(data, len, out);
+#endif
+            default:
+                return false;
+        }
+    }
+
+    CompressionType type_;
+    bool valid_ = false;
+    bool finished_ = false;
+
+private:
+#ifdef HAVE_ZLIB
+    bool feed_zlib(const uint8_t* data, size_t len, const OutputFn& out) {
+        zstream_.next_in = const_cast<uint8_t*>(data);
+        zstream_.avail_in = len;
+
+        const size_t chunk_size = 32768;
+        uint8_t temp[chunk_size];
+
+        while (zstream_.avail_in > 0 && !finished_) {
+            zstream_.next_out = temp;
+            zstream_.avail_out = chunk_size;
+
+            int ret = inflate(&zstream_, Z_NO_FLUSH);
+
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                valid_ = false;
+                return false;
+            }
+
+            size_t have = chunk_size - zstream_.avail_out;
+            if (have > 0 && !out(temp, have)) {
+                return false;
+            }
+
+            if (ret == Z_STREAM_END) {
+                finished_ = true;
+            } else if (ret == Z_BUF_ERROR && have == 0) {
+                break; // Needs more input
+            }
+        }
+        return true;
+    }
+#endif
+
+#ifdef HAVE_BROTLI
+    bool feed_brotli(const uint8_t* data, size_t len, const OutputFn& out) {
+        const uint8_t* next_in = data;
+        size_t avail_in = len;
+
+        const size_t chunk_size = 32768;
+        uint8_t temp[chunk_size];
+
+        while (!finished_) {
+            uint8_t* next_out = temp;
+            size_t avail_out = chunk_size;
+
+            BrotliDecoderResult result = BrotliDecoderDecompressStream(
+                brotli_, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+
+            if (result == BROTLI_DECODER_RESULT_ERROR) {
+                valid_ = false;
+                return false;
+            }
+
+            size_t have = chunk_size - avail_out;
+            if (have > 0 && !out(temp, have)) {
+                return false;
+            }
+
+            if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+                finished_ = true;
+            } else if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
+                break;
+            }
+            // NEEDS_MORE_OUTPUT: loop again with a fresh output buffer
+        }
+        return true;
+    }
+
+    BrotliDecoderState* brotli_ = nullptr;
+#endif
+
+#ifdef HAVE_ZLIB
+    z_stream zstream_{};
+    bool z_active_ = false;
+#endif
+};
+
+StreamingDecompressor::StreamingDecompressor(CompressionType type)
+    : impl_(std::make_unique<Impl>(type)) {
+}
+
+StreamingDecompressor::~StreamingDecompressor() = default;
+
+bool StreamingDecompressor::valid() const {
+    return impl_->valid_;
+}
+
+bool StreamingDecompressor::feed(const uint8_t* data, size_t len, const OutputFn& out) {
+    return impl_->feed(data, len, out);
+}
+
+bool StreamingDecompressor::finished() const {
+    return impl_->finished_;
+}
+
 } // namespace crawl
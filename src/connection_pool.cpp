@@ -1,44 +1,75 @@
 #include "connection_pool.hpp"
 #include "happy_eyeballs.hpp"
 #include "tls_connection.hpp"
+#include "http2_client.hpp"
 #include <sys/socket.h>
 #include <unistd.h>
 #include <algorithm>
+#include <functional>
 #include <errno.h>
 
 namespace crawl {
 
 ConnectionPool::ConnectionPool(int max_connections, std::chrono::seconds idle_timeout)
     : max_connections_(max_connections), idle_timeout_(idle_timeout) {
+
+    // Reap idle connections in the background so the pool self-maintains
+    reaper_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(reaper_mutex_);
+        while (!shutting_down_) {
+            auto interval = std::max<std::chrono::seconds>(
+                std::chrono::seconds(1), idle_timeout_ / 4);
+            reaper_cv_.wait_for(lock, interval, [this]() { return shutting_down_; });
+            if (shutting_down_) break;
+
+            lock.unlock();
+            cleanup_idle();
+            lock.lock();
+        }
+    });
 }
 
 ConnectionPool::~ConnectionPool() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    for (auto& pool_pair : pools_) {
-        for (auto& conn : pool_pair.second) {
-            if (conn->socket_fd >= 0) {
-                ::close(conn->socket_fd);
+    {
+        std::lock_guard<std::mutex> lock(reaper_mutex_);
+        shutting_down_ = true;
+    }
+    reaper_cv_.notify_one();
+    if (reaper_.joinable()) {
+        reaper_.join();
+    }
+
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& pool_pair : shard.pools) {
+            for (auto& conn : pool_pair.second) {
+                if (conn->socket_fd >= 0) {
+                    ::close(conn->socket_fd);
+                }
             }
         }
     }
 }
 
+ConnectionPool::Shard& ConnectionPool::shard_for(const std::string& host) {
+    return shards_[std::hash<std::string>{}(host) % NUM_SHARDS];
+}
+
 std::shared_ptr<PooledConnection> ConnectionPool::create_connection(
     const std::string& host, int port, bool use_tls) {
-    
+
     HappyEyeballs he(host, port);
     int fd = he.connect(std::chrono::milliseconds(10000));
-    
+
     if (fd < 0) {
         return nullptr;
     }
-    
+
     auto conn = std::make_shared<PooledConnection>();
     conn->socket_fd = fd;
     conn->in_use = true;
     conn->last_used = std::chrono::steady_clock::now();
-    
+
     if (use_tls) {
         conn->tls = std::make_unique<TLSConnection>(fd, host);
         if (!conn->tls->handshake()) {
@@ -46,26 +77,27 @@ std::shared_ptr<PooledConnection> ConnectionPool::create_connection(
             return nullptr;
         }
     }
-    
+
     return conn;
 }
 
 std::shared_ptr<PooledConnection> ConnectionPool::acquire(
     const std::string& host, int port, bool use_tls) {
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+
+    Shard& shard = shard_for(host);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
     PoolKey key{host, port, use_tls};
-    
+
     // Only return an EXISTING idle connection — never create a new one here.
     // New connections must be created by the caller so timing can be recorded.
-    auto it = pools_.find(key);
-    if (it != pools_.end()) {
+    auto it = shard.pools.find(key);
+    if (it != shard.pools.end()) {
         auto& pool = it->second;
         for (int i = (int)pool.size() - 1; i >= 0; --i) {
             auto& conn = pool[i];
             if (!conn || conn->in_use) continue;
-            
+
             // Check if connection is still alive
             char buf[1];
             ssize_t ret = ::recv(conn->socket_fd, buf, 1, MSG_PEEK | MSG_DONTWAIT);
@@ -73,73 +105,115 @@ std::shared_ptr<PooledConnection> ConnectionPool::acquire(
                 // Dead — close and remove
                 ::close(conn->socket_fd);
                 pool.erase(pool.begin() + i);
+                total_idle_.fetch_sub(1, std::memory_order_relaxed);
                 continue;
             }
-            
+
             conn->in_use = true;
             conn->last_used = std::chrono::steady_clock::now();
+            total_idle_.fetch_sub(1, std::memory_order_relaxed);
             return conn;
         }
     }
-    
+
     // No existing connection available — caller creates a new one with timing
     return nullptr;
 }
 
+bool ConnectionPool::evict_lru_locked(Shard& shard) {
+    std::vector<std::shared_ptr<PooledConnection>>* lru_pool = nullptr;
+    size_t lru_index = 0;
+    auto lru_time = std::chrono::steady_clock::time_point::max();
+
+    for (auto& pool_pair : shard.pools) {
+        auto& pool = pool_pair.second;
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if (!pool[i]->in_use && pool[i]->last_used < lru_time) {
+                lru_time = pool[i]->last_used;
+                lru_pool = &pool;
+                lru_index = i;
+            }
+        }
+    }
+
+    if (!lru_pool) {
+        return false;
+    }
+
+    ::close((*lru_pool)[lru_index]->socket_fd);
+    lru_pool->erase(lru_pool->begin() + lru_index);
+    total_idle_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
 void ConnectionPool::release(const std::string& host, int port,
                              std::shared_ptr<PooledConnection> conn) {
     if (!conn || conn->socket_fd < 0) {
         return;
     }
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+
+    Shard& shard = shard_for(host);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
     PoolKey key{host, port, conn->tls != nullptr};
-    
+
     conn->in_use = false;
     conn->last_used = std::chrono::steady_clock::now();
-    
-    // Add to pool
-    auto& pool = pools_[key];
-    
-    // Check if we're at capacity
-    int total_conns = 0;
-    for (const auto& p : pools_) {
-        total_conns += p.second.size();
-    }
-    
-    if (total_conns >= max_connections_) {
-        // Close the oldest idle connection
-        ::close(conn->socket_fd);
-        return;
+
+    // Enforce the global cap: evict the shard's LRU idle connection to make
+    // room; if this shard has none, the incoming connection is the extra one
+    if (total_idle_.load(std::memory_order_relaxed) >= max_connections_.load(std::memory_order_relaxed)) {
+        if (!evict_lru_locked(shard)) {
+            ::close(conn->socket_fd);
+            return;
+        }
     }
-    
-    pool.push_back(conn);
+
+    shard.pools[key].push_back(conn);
+    total_idle_.fetch_add(1, std::memory_order_relaxed);
 }
 
 void ConnectionPool::cleanup_idle() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     auto now = std::chrono::steady_clock::now();
-    
-    for (auto& pool_pair : pools_) {
-        auto& pool = pool_pair.second;
-        
-        pool.erase(
-            std::remove_if(pool.begin(), pool.end(),
-                [&](const std::shared_ptr<PooledConnection>& conn) {
-                    if (!conn->in_use) {
-                        auto idle_time = std::chrono::duration_cast<std::chrono::seconds>(
-                            now - conn->last_used);
-                        
-                        if (idle_time >= idle_timeout_) {
-                            ::close(conn->socket_fd);
-                            return true;
+
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (auto& pool_pair : shard.pools) {
+            auto& pool = pool_pair.second;
+
+            pool.erase(
+                std::remove_if(pool.begin(), pool.end(),
+                    [&](const std::shared_ptr<PooledConnection>& conn) {
+                        if (!conn->in_use) {
+                            auto idle_time = std::chrono::duration_cast<std::chrono::seconds>(
+                                now - conn->last_used);
+
+                            if (idle_time >= idle_timeout_) {
+                                ::close(conn->socket_fd);
+                                total_idle_.fetch_sub(1, std::memory_order_relaxed);
+                                return true;
+                            }
                         }
-                    }
-                    return false;
-                }),
-            pool.end());
+                        return false;
+                    }),
+                pool.end());
+        }
+    }
+}
+
+void ConnectionPool::set_max_connections(int max_connections) {
+    if (max_connections < 1) {
+        max_connections = 1;
+    }
+    max_connections_.store(max_connections, std::memory_order_relaxed);
+
+    // Shed excess idle connections right away instead of waiting for releases
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (total_idle_.load(std::memory_order_relaxed) > max_connections &&
+               evict_lru_locked(shard)) {
+        }
     }
 }
 
@@ -0,0 +1,205 @@
+#include "disk_cache.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <ctime>
+#include <sys/stat.h>
+
+namespace crawl {
+
+namespace {
+
+// Stable across runs, unlike std::hash — entries must be addressable by a
+// later process
+uint64_t fnv1a(const std::string& s) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::string hash_name(const std::string& url) {
+    char buf[20];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)fnv1a(url));
+    return buf;
+}
+
+// Freshness lifetime in seconds from Cache-Control, or:
+//   -1  no-store — never cache
+//    0  always revalidate (no-cache, or no max-age given)
+long freshness_lifetime(const HeaderMap& headers) {
+    std::optional<std::string_view> cc = headers.get("cache-control");
+    if (!cc) {
+        return 0;
+    }
+    if (cc->find("no-store") != std::string_view::npos) {
+        return -1;
+    }
+    if (cc->find("no-cache") != std::string_view::npos) {
+        return 0;
+    }
+    size_t pos = cc->find("max-age=");
+    if (pos != std::string_view::npos) {
+        return std::atol(std::string(cc->substr(pos + 8)).c_str());
+    }
+    return 0;
+}
+
+} // anonymous namespace
+
+DiskCache::DiskCache(const std::string& dir) : dir_(dir) {
+    ::mkdir(dir_.c_str(), 0755);
+}
+
+std::string DiskCache::meta_path(const std::string& url) const {
+    return dir_ + "/" + hash_name(url) + ".meta";
+}
+
+std::string DiskCache::body_path(const std::string& url) const {
+    return dir_ + "/" + hash_name(url) + ".body";
+}
+
+std::optional<DiskCache::Hit> DiskCache::lookup(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::ifstream meta(meta_path(url));
+    if (!meta) {
+        return std::nullopt;
+    }
+
+    Hit hit;
+    time_t stored = 0;
+    long max_age = 0;
+
+    // Line format: "status <code> <message>", "stored <unix>", "maxage <sec>",
+    // then one "header <name>: <value>" per header
+    std::string line;
+    while (std::getline(meta, line)) {
+        if (line.rfind("status ", 0) == 0) {
+            std::istringstream is(line.substr(7));
+            is >> hit.response.status_code;
+            std::getline(is, hit.response.status_message);
+            if (!hit.response.status_message.empty() &&
+                hit.response.status_message[0] == ' ') {
+                hit.response.status_message.erase(0, 1);
+            }
+        } else if (line.rfind("stored ", 0) == 0) {
+            stored = (time_t)std::atoll(line.c_str() + 7);
+        } else if (line.rfind("maxage ", 0) == 0) {
+            max_age = std::atol(line.c_str() + 7);
+        } else if (line.rfind("header ", 0) == 0) {
+            size_t colon = line.find(": ", 7);
+            if (colon != std::string::npos) {
+                hit.response.headers.add(
+                    std::string_view(line).substr(7, colon - 7),
+                    std::string_view(line).substr(colon + 2));
+            }
+        }
+    }
+    if (hit.response.status_code == 0) {
+        return std::nullopt; // torn or foreign file
+    }
+
+    std::ifstream body(body_path(url), std::ios::binary);
+    if (!body) {
+        return std::nullopt;
+    }
+    hit.response.body.assign(std::istreambuf_iterator<char>(body),
+                             std::istreambuf_iterator<char>());
+    hit.response.bytes_received = hit.response.body.size();
+
+    hit.fresh = (::time(nullptr) - stored) < max_age;
+    if (auto etag = hit.response.headers.get("etag")) {
+        hit.etag = *etag;
+    }
+    if (auto lm = hit.response.headers.get("last-modified")) {
+        hit.last_modified = *lm;
+    }
+    return hit;
+}
+
+bool DiskCache::write_meta(const std::string& url, const Response& resp,
+                           long max_age) {
+    std::string path = meta_path(url);
+    std::string tmp = path + ".tmp";
+
+    std::ofstream meta(tmp, std::ios::trunc);
+    if (!meta) {
+        return false;
+    }
+    meta << "status " << resp.status_code << " " << resp.status_message << "\n";
+    meta << "stored " << (long long)::time(nullptr) << "\n";
+    meta << "maxage " << max_age << "\n";
+    for (const auto& [key, value] : resp.headers) {
+        if (key.find('\n') == std::string_view::npos &&
+            value.find('\n') == std::string_view::npos) {
+            meta << "header " << key << ": " << value << "\n";
+        }
+    }
+    meta.close();
+    if (!meta.good()) {
+        ::remove(tmp.c_str());
+        return false;
+    }
+    return ::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+void DiskCache::store(const std::string& url, const Response& resp) {
+    long max_age = freshness_lifetime(resp.headers);
+    if (max_age < 0) {
+        return; // no-store
+    }
+    if (max_age == 0 &&
+        !resp.headers.contains("etag") &&
+        !resp.headers.contains("last-modified")) {
+        return; // no lifetime and no validator — refetching would be cheaper
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Body first: a meta file must never point at a missing body
+    std::string bpath = body_path(url);
+    std::string btmp = bpath + ".tmp";
+    {
+        std::ofstream body(btmp, std::ios::binary | std::ios::trunc);
+        if (!body) {
+            return;
+        }
+        body.write(reinterpret_cast<const char*>(resp.body.data()),
+                   (std::streamsize)resp.body.size());
+        if (!body.good()) {
+            ::remove(btmp.c_str());
+            return;
+        }
+    }
+    if (::rename(btmp.c_str(), bpath.c_str()) != 0) {
+        ::remove(btmp.c_str());
+        return;
+    }
+
+    write_meta(url, resp, max_age);
+}
+
+void DiskCache::refresh(const std::string& url, const Response& resp304) {
+    // Re-read the stored entry, then restamp it; the 304 may carry an
+    // updated Cache-Control
+    std::optional<Hit> hit = lookup(url);
+    if (!hit) {
+        return;
+    }
+    for (const auto& [key, value] : resp304.headers) {
+        hit->response.headers.set(key, value); // 304 headers override stored ones
+    }
+    long max_age = freshness_lifetime(hit->response.headers);
+    if (max_age < 0) {
+        max_age = 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_meta(url, hit->response, max_age);
+}
+
+} // namespace crawl
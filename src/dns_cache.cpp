@@ -9,6 +9,18 @@ namespace crawl {
 
 DNSCache::DNSCache(std::chrono::seconds default_ttl)
     : default_ttl_(default_ttl) {
+    refresher_ = std::thread([this]() { refresher_loop(); });
+}
+
+DNSCache::~DNSCache() {
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        shutting_down_ = true;
+    }
+    refresh_cv_.notify_one();
+    if (refresher_.joinable()) {
+        refresher_.join();
+    }
 }
 
 std::string DNSCache::make_key(const std::string& host, int port) const {
@@ -21,61 +33,135 @@ std::vector<sockaddr_storage> DNSCache::do_resolve(const std::string& host, int
     hints.ai_socktype = SOCK_STREAM;
     hints.ai_protocol = IPPROTO_TCP;
     hints.ai_flags = AI_ADDRCONFIG;
-    
+
     struct addrinfo* result = nullptr;
     std::string port_str = std::to_string(port);
-    
+
     int ret = getaddrinfo(host.c_str(), port_str.c_str(), &hints, &result);
     if (ret != 0) {
         return {};
     }
-    
+
     std::vector<sockaddr_storage> addresses;
     for (struct addrinfo* rp = result; rp != nullptr; rp = rp->ai_next) {
         sockaddr_storage addr{};
         std::memcpy(&addr, rp->ai_addr, rp->ai_addrlen);
         addresses.push_back(addr);
     }
-    
+
     freeaddrinfo(result);
     return addresses;
 }
 
+void DNSCache::schedule_refresh(const std::string& key, const std::string& host, int port) {
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        if (shutting_down_) {
+            return;
+        }
+        refresh_queue_.push_back({key, host, port});
+    }
+    refresh_cv_.notify_one();
+}
+
+void DNSCache::refresher_loop() {
+    std::unique_lock<std::mutex> lock(refresh_mutex_);
+
+    while (true) {
+        refresh_cv_.wait(lock, [this]() {
+            return shutting_down_ || !refresh_queue_.empty();
+        });
+        if (shutting_down_) {
+            break;
+        }
+
+        RefreshJob job = std::move(refresh_queue_.front());
+        refresh_queue_.pop_front();
+        lock.unlock();
+
+        // Resolve without holding any cache lock — this is the slow part
+        auto addresses = do_resolve(job.host, job.port);
+
+        {
+            std::lock_guard<std::mutex> cache_lock(mutex_);
+            CachedAddress cached;
+            cached.cached_at = std::chrono::steady_clock::now();
+            if (addresses.empty()) {
+                cached.negative = true;
+                cached.ttl = negative_ttl_;
+            } else {
+                cached.addresses = std::move(addresses);
+                cached.ttl = default_ttl_;
+            }
+            cache_[job.key] = std::move(cached);
+        }
+
+        lock.lock();
+    }
+}
+
 std::vector<sockaddr_storage> DNSCache::resolve(const std::string& host, int port) {
     std::string key = make_key(host, port);
-    
+
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        
+
         auto it = cache_.find(key);
         if (it != cache_.end()) {
             auto now = std::chrono::steady_clock::now();
             auto age = std::chrono::duration_cast<std::chrono::seconds>(now - it->second.cached_at);
-            
-            if (age < it->second.ttl) {
+
+            if (it->second.negative) {
+                if (age < it->second.ttl) {
+                    // Recently failed — don't hit the resolver again yet
+                    hits_++;
+                    return {};
+                }
+                // Negative entry expired — fall through to a fresh resolve
+                cache_.erase(it);
+            } else if (age < it->second.ttl) {
                 hits_++;
+                // Refresh-ahead: in the last quarter of the TTL, re-resolve in
+                // the background so the entry never actually expires on a hot host
+                if (age >= it->second.ttl - it->second.ttl / 4 && !it->second.refreshing) {
+                    it->second.refreshing = true;
+                    schedule_refresh(key, host, port);
+                }
                 return it->second.addresses;
             } else {
-                // Entry expired
-                cache_.erase(it);
+                // Stale-while-revalidate: serve the expired entry and refresh
+                // asynchronously instead of blocking on getaddrinfo here
+                hits_++;
+                if (!it->second.refreshing) {
+                    it->second.refreshing = true;
+                    schedule_refresh(key, host, port);
+                }
+                return it->second.addresses;
             }
         }
-        
+
         misses_++;
     }
-    
+
     // Resolve DNS
     auto addresses = do_resolve(host, port);
-    
-    if (!addresses.empty()) {
+
+    {
         std::lock_guard<std::mutex> lock(mutex_);
         CachedAddress cached;
-        cached.addresses = addresses;
         cached.cached_at = std::chrono::steady_clock::now();
-        cached.ttl = default_ttl_;
+        if (addresses.empty()) {
+            // Negative cache: a dead host in a batch file shouldn't trigger a
+            // resolver round trip for every URL
+            cached.negative = true;
+            cached.ttl = negative_ttl_;
+        } else {
+            cached.addresses = addresses;
+            cached.ttl = default_ttl_;
+        }
         cache_[key] = std::move(cached);
     }
-    
+
     return addresses;
 }
 
@@ -85,12 +171,14 @@ void DNSCache::warmup(const std::string& host, int port) {
 
 void DNSCache::cleanup() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
     auto now = std::chrono::steady_clock::now();
-    
+
     for (auto it = cache_.begin(); it != cache_.end(); ) {
         auto age = std::chrono::duration_cast<std::chrono::seconds>(now - it->second.cached_at);
-        if (age >= it->second.ttl) {
+        // Keep expired entries that are being refreshed — they're still
+        // serving stale answers until the new resolution lands
+        if (age >= it->second.ttl && !it->second.refreshing) {
             it = cache_.erase(it);
         } else {
             ++it;
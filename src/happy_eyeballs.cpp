@@ -19,6 +19,59 @@
 
 namespace crawl {
 
+// ─────────────────────────────────────────────────────────────────────────────
+// ConnectOutcomeCache
+// ─────────────────────────────────────────────────────────────────────────────
+
+namespace {
+
+std::string outcome_key(const std::string& host, int port) {
+    return host + ":" + std::to_string(port);
+}
+
+// Remember the endpoint behind a freshly connected socket
+void record_winner(const std::string& host, int port, int fd) {
+    AddressInfo info{};
+    info.addrlen = sizeof(info.addr);
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&info.addr), &info.addrlen) != 0) {
+        return;
+    }
+    info.family = info.addr.ss_family;
+    info.socktype = SOCK_STREAM;
+    info.protocol = IPPROTO_TCP;
+    ConnectOutcomeCache::instance().record(host, port, info);
+}
+
+} // anonymous namespace
+
+ConnectOutcomeCache& ConnectOutcomeCache::instance() {
+    static ConnectOutcomeCache cache;
+    return cache;
+}
+
+std::optional<AddressInfo> ConnectOutcomeCache::lookup(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(outcome_key(host, port));
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    if (std::chrono::steady_clock::now() - it->second.connected_at >= TTL) {
+        entries_.erase(it);
+        return std::nullopt;
+    }
+    return it->second.addr;
+}
+
+void ConnectOutcomeCache::record(const std::string& host, int port, const AddressInfo& addr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[outcome_key(host, port)] = {addr, std::chrono::steady_clock::now()};
+}
+
+void ConnectOutcomeCache::invalidate(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(outcome_key(host, port));
+}
+
 HappyEyeballs::HappyEyeballs(const std::string& host, int port)
     : host_(host), port_(port) {
 }
@@ -228,42 +281,63 @@ int HappyEyeballs::try_connect_parallel(const std::vector<AddressInfo>& addrs,
 }
 
 int HappyEyeballs::connect(std::chrono::milliseconds timeout) {
+    auto& outcomes = ConnectOutcomeCache::instance();
+
+    // Fast path: go straight at the endpoint that won the last race — no
+    // resolution, no staggering. A failure invalidates the entry and falls
+    // through to the full race.
+    if (auto known = outcomes.lookup(host_, port_)) {
+        int fd = attempt_connection(*known,
+                                    std::min(timeout, std::chrono::milliseconds(2000)));
+        if (fd >= 0) {
+            outcomes.record(host_, port_, *known); // refresh the TTL
+            return fd;
+        }
+        outcomes.invalidate(host_, port_);
+    }
+
     if (!resolve_addresses()) {
         return -1;
     }
-    
+
     // RFC 8305: Prefer IPv6, but start IPv4 soon after
     // We'll try both in parallel with staggering
-    
+
     auto start_time = std::chrono::steady_clock::now();
-    
+
     // Start with IPv6 if available
     if (!ipv6_addrs_.empty()) {
         int fd = try_connect_parallel(ipv6_addrs_, RESOLUTION_DELAY);
         if (fd >= 0) {
+            record_winner(host_, port_, fd);
             return fd;
         }
     }
-    
+
     auto elapsed = std::chrono::steady_clock::now() - start_time;
     auto remaining = timeout - std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
-    
+
     // Try IPv4
     if (!ipv4_addrs_.empty() && remaining.count() > 0) {
         int fd = try_connect_parallel(ipv4_addrs_, remaining);
         if (fd >= 0) {
+            record_winner(host_, port_, fd);
             return fd;
         }
     }
-    
+
     // If IPv6 is still pending, give it more time
     elapsed = std::chrono::steady_clock::now() - start_time;
     remaining = timeout - std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
-    
+
     if (!ipv6_addrs_.empty() && remaining.count() > 0) {
-        return try_connect_parallel(ipv6_addrs_, remaining);
+        int fd = try_connect_parallel(ipv6_addrs_, remaining);
+        if (fd >= 0) {
+            record_winner(host_, port_, fd);
+        }
+        return fd;
     }
-    
+
     return -1;
 }
 
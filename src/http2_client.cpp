@@ -1,17 +1,64 @@
 #include "http2_client.hpp"
-
-// This is a basic stub implementation for HTTP/2 support
-// Full implementation would require significant additional code
+#include "tls_connection.hpp"
+#include <cstring>
+#include <algorithm>
 
 namespace crawl {
 
 #ifdef HAVE_NGHTTP2
 
-// HTTP/2 implementation would go here
-// For now, we'll provide a minimal stub
+namespace {
+
+// Per-stream state hung off nghttp2's stream_user_data
+struct StreamContext {
+    HTTP2Response resp;
+    const std::vector<uint8_t>* body = nullptr; // request body being uploaded
+    size_t body_offset = 0;
+    bool done = false;
+};
+
+nghttp2_nv make_nv(const char* name, const std::string& value) {
+    nghttp2_nv nv;
+    nv.name = reinterpret_cast<uint8_t*>(const_cast<char*>(name));
+    nv.namelen = strlen(name);
+    nv.value = reinterpret_cast<uint8_t*>(const_cast<char*>(value.c_str()));
+    nv.valuelen = value.size();
+    nv.flags = NGHTTP2_NV_FLAG_NONE;
+    return nv;
+}
+
+// Request body read callback for uploads
+ssize_t body_read_cb(nghttp2_session* session, int32_t stream_id,
+                     uint8_t* buf, size_t length, uint32_t* data_flags,
+                     nghttp2_data_source* source, void* user_data) {
+    (void)session; (void)stream_id; (void)user_data;
+    auto* ctx = static_cast<StreamContext*>(source->ptr);
+
+    size_t remaining = ctx->body->size() - ctx->body_offset;
+    size_t take = std::min(length, remaining);
+    if (take > 0) {
+        memcpy(buf, ctx->body->data() + ctx->body_offset, take);
+        ctx->body_offset += take;
+    }
+    if (ctx->body_offset >= ctx->body->size()) {
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    }
+    return static_cast<ssize_t>(take);
+}
+
+// Hop-by-hop headers have no place in HTTP/2
+bool is_connection_header(std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower == "host" || lower == "connection" || lower == "keep-alive" ||
+           lower == "transfer-encoding" || lower == "upgrade" ||
+           lower == "proxy-connection";
+}
 
-HTTP2Session::HTTP2Session(int socket_fd, const std::string& host)
-    : socket_fd_(socket_fd), host_(host) {
+} // anonymous namespace
+
+HTTP2Session::HTTP2Session(TLSConnection* tls, const std::string& host)
+    : tls_(tls), host_(host) {
 }
 
 HTTP2Session::~HTTP2Session() {
@@ -20,47 +67,209 @@ HTTP2Session::~HTTP2Session() {
     }
 }
 
+ssize_t HTTP2Session::cb_send(nghttp2_session*, const uint8_t* data,
+                              size_t length, int, void* user_data) {
+    auto* self = static_cast<HTTP2Session*>(user_data);
+    ssize_t n = self->tls_->send(data, length);
+    if (n <= 0) {
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    }
+    return n;
+}
+
+int HTTP2Session::cb_on_header(nghttp2_session* session, const nghttp2_frame* frame,
+                               const uint8_t* name, size_t namelen,
+                               const uint8_t* value, size_t valuelen,
+                               uint8_t, void*) {
+    if (frame->hd.type != NGHTTP2_HEADERS ||
+        frame->headers.cat != NGHTTP2_HCAT_RESPONSE) {
+        return 0;
+    }
+
+    auto* ctx = static_cast<StreamContext*>(
+        nghttp2_session_get_stream_user_data(session, frame->hd.stream_id));
+    if (!ctx) {
+        return 0;
+    }
+
+    std::string key(reinterpret_cast<const char*>(name), namelen);
+    std::string val(reinterpret_cast<const char*>(value), valuelen);
+
+    if (key == ":status") {
+        ctx->resp.status_code = std::atoi(val.c_str());
+    } else if (!key.empty() && key[0] != ':') {
+        ctx->resp.headers.add(key, val);
+    }
+    return 0;
+}
+
+int HTTP2Session::cb_on_data_chunk(nghttp2_session* session, uint8_t,
+                                   int32_t stream_id, const uint8_t* data,
+                                   size_t len, void*) {
+    auto* ctx = static_cast<StreamContext*>(
+        nghttp2_session_get_stream_user_data(session, stream_id));
+    if (ctx) {
+        ctx->resp.body.insert(ctx->resp.body.end(), data, data + len);
+    }
+    return 0;
+}
+
+int HTTP2Session::cb_on_stream_close(nghttp2_session* session, int32_t stream_id,
+                                     uint32_t, void* user_data) {
+    auto* self = static_cast<HTTP2Session*>(user_data);
+    auto* ctx = static_cast<StreamContext*>(
+        nghttp2_session_get_stream_user_data(session, stream_id));
+    if (ctx && !ctx->done) {
+        ctx->done = true;
+        if (self->pending_streams_ > 0) {
+            self->pending_streams_--;
+        }
+    }
+    return 0;
+}
+
 bool HTTP2Session::init() {
-    // Initialize nghttp2 session
     nghttp2_session_callbacks* callbacks = nullptr;
     nghttp2_session_callbacks_new(&callbacks);
-    
+    nghttp2_session_callbacks_set_send_callback(callbacks, cb_send);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, cb_on_header);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, cb_on_data_chunk);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, cb_on_stream_close);
+
     int rv = nghttp2_session_client_new(&session_, callbacks, this);
     nghttp2_session_callbacks_del(callbacks);
-    
+
     if (rv != 0) {
         return false;
     }
-    
-    // Send connection preface and SETTINGS
-    return send_connection_header() && send_settings();
-}
 
-bool HTTP2Session::send_connection_header() {
-    // Send HTTP/2 connection preface
-    // Would need to actually send via socket in full implementation
-    (void)socket_fd_; // Suppress unused warning
-    return true;
+    // nghttp2 emits the client connection preface with the first send
+    alive_ = send_settings();
+    return alive_;
 }
 
 bool HTTP2Session::send_settings() {
-    // Send SETTINGS frame
+    nghttp2_settings_entry settings[] = {
+        { NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 100 },
+        { NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, 1 << 20 },
+    };
+    if (nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings, 2) != 0) {
+        return false;
+    }
+    return nghttp2_session_send(session_) == 0;
+}
+
+// Pump the session: flush pending frames, read from the TLS connection, and
+// feed bytes back to nghttp2 until every submitted stream has closed.
+bool HTTP2Session::run_io() {
+    uint8_t buffer[65536];
+
+    while (pending_streams_ > 0) {
+        if (nghttp2_session_want_write(session_)) {
+            if (nghttp2_session_send(session_) != 0) {
+                alive_ = false;
+                return false;
+            }
+        }
+
+        if (!nghttp2_session_want_read(session_) && !nghttp2_session_want_write(session_)) {
+            alive_ = false;
+            return false; // session wound down with streams still pending
+        }
+
+        ssize_t n = tls_->recv(buffer, sizeof(buffer));
+        if (n < 0) {
+            alive_ = false;
+            return false;
+        }
+        if (n == 0) {
+            continue; // TLS layer would block; blocking socket will wait
+        }
+
+        ssize_t consumed = nghttp2_session_mem_recv(session_, buffer, n);
+        if (consumed < 0) {
+            alive_ = false;
+            return false;
+        }
+    }
     return true;
 }
 
 std::optional<HTTP2Response> HTTP2Session::request(const HTTP2Request& req) {
-    // Simplified HTTP/2 request
-    // Real implementation would need full nghttp2 integration
-    return std::nullopt;
+    auto responses = batch_request({req});
+    if (responses.empty()) {
+        return std::nullopt;
+    }
+    return responses[0];
 }
 
 std::vector<HTTP2Response> HTTP2Session::batch_request(const std::vector<HTTP2Request>& requests) {
-    // HTTP/2 multiplexing would allow sending all requests simultaneously
-    return {};
+    if (!session_ || !alive_ || requests.empty()) {
+        return {};
+    }
+
+    std::vector<std::unique_ptr<StreamContext>> contexts;
+    contexts.reserve(requests.size());
+
+    // Submit everything up front — that's the whole point of multiplexing
+    for (const auto& req : requests) {
+        auto ctx = std::make_unique<StreamContext>();
+
+        std::vector<nghttp2_nv> nva;
+        nva.reserve(4 + req.headers.size());
+        nva.push_back(make_nv(":method", req.method));
+        nva.push_back(make_nv(":scheme", "https"));
+        nva.push_back(make_nv(":authority", host_));
+        nva.push_back(make_nv(":path", req.path));
+
+        for (const auto& [key, value] : req.headers) {
+            if (is_connection_header(key)) continue;
+            nghttp2_nv nv;
+            nv.name = reinterpret_cast<uint8_t*>(const_cast<char*>(key.data()));
+            nv.namelen = key.size();
+            nv.value = reinterpret_cast<uint8_t*>(const_cast<char*>(value.data()));
+            nv.valuelen = value.size();
+            nv.flags = NGHTTP2_NV_FLAG_NONE;
+            nva.push_back(nv);
+        }
+
+        int32_t stream_id;
+        if (!req.body.empty()) {
+            ctx->body = &req.body;
+            nghttp2_data_provider provider;
+            provider.source.ptr = ctx.get();
+            provider.read_callback = body_read_cb;
+            stream_id = nghttp2_submit_request(session_, nullptr, nva.data(),
+                                               nva.size(), &provider, ctx.get());
+        } else {
+            stream_id = nghttp2_submit_request(session_, nullptr, nva.data(),
+                                               nva.size(), nullptr, ctx.get());
+        }
+
+        if (stream_id < 0) {
+            ctx->done = true;
+            ctx->resp.status_code = 0;
+        } else {
+            pending_streams_++;
+        }
+        contexts.push_back(std::move(ctx));
+    }
+
+    run_io();
+
+    std::vector<HTTP2Response> responses;
+    responses.reserve(contexts.size());
+    for (auto& ctx : contexts) {
+        if (!ctx->done) {
+            ctx->resp.status_code = 0; // stream never finished
+        }
+        responses.push_back(std::move(ctx->resp));
+    }
+    return responses;
 }
 
 bool HTTP2Session::is_alive() const {
-    return session_ != nullptr;
+    return session_ != nullptr && alive_;
 }
 
 #endif // HAVE_NGHTTP2
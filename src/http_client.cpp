@@ -3,9 +3,14 @@
 #include "tls_connection.hpp"
 #include "connection_pool.hpp"
 #include "dns_cache.hpp"
+#include "disk_cache.hpp"
 #include "compression.hpp"
+#include "http_parser.hpp"
+#include "http2_client.hpp"
+#include "http3_client.hpp"
 #include "rate_limiter.hpp"
 #include "stats.hpp"
+#include "trace.hpp"
 #include <sstream>
 #include <algorithm>
 #include <cctype>
@@ -13,13 +18,21 @@
 #include <sys/socket.h>
 #include <netinet/tcp.h>
 #include <poll.h>
+#include <sys/epoll.h>
 #include <fcntl.h>
 #include <cstring>
 #include <thread>
+#include <atomic>
 #include <future>
+#include <condition_variable>
 #include <queue>
+#include <unordered_set>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <cerrno>
 
 // MSG_NOSIGNAL doesn't exist on some systems
 #ifndef MSG_NOSIGNAL
@@ -34,44 +47,139 @@ std::atomic<bool> g_progress_thread_running{false};
 namespace crawl {
 
 std::optional<URL> URL::parse(const std::string& url) {
-    // Optimized URL parser without regex
-    URL result;
-    
+    // All parsing lives in the zero-copy URLView; materialize on success
+    auto view = URLView::parse(url);
+    if (!view) {
+        return std::nullopt;
+    }
+    return view->to_url();
+}
+
+std::string URL::to_string() const {
+    std::string result = scheme + "://" + host;
+    if ((scheme == "http" && port != 80) || (scheme == "https" && port != 443)) {
+        result += ":" + std::to_string(port);
+    }
+    result += path;
+    if (!query.empty()) {
+        result += "?" + query;
+    }
+    return result;
+}
+
+namespace {
+
+// Case-insensitive header name comparison without allocating lowercase copies
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (::tolower((unsigned char)a[i]) != ::tolower((unsigned char)b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Headers that change per request (Range in parallel downloads, explicit
+// Content-Length) are appended after the cached prefix, never baked into it
+bool is_volatile_header(std::string_view name) {
+    return iequals(name, "range") || iequals(name, "content-length");
+}
+
+// Steady-clock time point on the tracing timebase (trace::now_us)
+uint64_t steady_us(std::chrono::steady_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               tp.time_since_epoch())
+        .count();
+}
+
+// Write two buffers with a single sendmsg so header and body leave in one
+// syscall — and one TCP segment when they fit. Loops on partial writes,
+// advancing the iovecs past whatever the kernel took.
+bool send_all_vectored(int fd, const uint8_t* a, size_t a_len,
+                       const uint8_t* b, size_t b_len) {
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<uint8_t*>(a);
+    iov[0].iov_len  = a_len;
+    iov[1].iov_base = const_cast<uint8_t*>(b);
+    iov[1].iov_len  = b_len;
+
+    struct msghdr msg {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    size_t remaining = a_len + b_len;
+    while (remaining > 0) {
+        ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        remaining -= (size_t)n;
+
+        size_t taken = (size_t)n;
+        for (auto& v : iov) {
+            size_t step = std::min(taken, v.iov_len);
+            v.iov_base = (uint8_t*)v.iov_base + step;
+            v.iov_len -= step;
+            taken -= step;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+std::optional<URLView> URLView::parse(std::string_view url) {
+    // Optimized URL parser without regex or allocations
+    URLView result;
+
     // Find scheme
     size_t scheme_end = url.find("://");
-    if (scheme_end == std::string::npos) {
+    if (scheme_end == std::string_view::npos) {
         return std::nullopt;
     }
-    
     result.scheme = url.substr(0, scheme_end);
-    std::transform(result.scheme.begin(), result.scheme.end(), 
-                   result.scheme.begin(), ::tolower);
-    
+
     size_t pos = scheme_end + 3;
-    
+
     // Find host/port boundary
     size_t path_start = url.find('/', pos);
     size_t query_start = url.find('?', pos);
     size_t host_end = std::min(path_start, query_start);
-    if (host_end == std::string::npos) {
-        host_end = url.length();
+    if (host_end == std::string_view::npos) {
+        host_end = url.size();
     }
-    
-    std::string host_port = url.substr(pos, host_end - pos);
-    
+
+    std::string_view host_port = url.substr(pos, host_end - pos);
+
     // Parse host and port
     size_t port_delim = host_port.find(':');
-    if (port_delim != std::string::npos) {
+    if (port_delim != std::string_view::npos) {
         result.host = host_port.substr(0, port_delim);
-        result.port = std::stoi(host_port.substr(port_delim + 1));
+        int port = 0;
+        std::string_view digits = host_port.substr(port_delim + 1);
+        if (digits.empty()) {
+            return std::nullopt;
+        }
+        for (char c : digits) {
+            if (c < '0' || c > '9') {
+                return std::nullopt;
+            }
+            port = port * 10 + (c - '0');
+            if (port > 65535) {
+                return std::nullopt;
+            }
+        }
+        result.port = port;
     } else {
         result.host = host_port;
-        result.port = (result.scheme == "https") ? 443 : 80;
+        result.port = result.is_https() ? 443 : 80;
     }
-    
+
     // Parse path and query
-    if (path_start != std::string::npos) {
-        if (query_start != std::string::npos && query_start > path_start) {
+    if (path_start != std::string_view::npos) {
+        if (query_start != std::string_view::npos && query_start > path_start) {
             result.path = url.substr(path_start, query_start - path_start);
             result.query = url.substr(query_start + 1);
         } else {
@@ -79,23 +187,27 @@ std::optional<URL> URL::parse(const std::string& url) {
         }
     } else {
         result.path = "/";
-        if (query_start != std::string::npos) {
+        if (query_start != std::string_view::npos) {
             result.query = url.substr(query_start + 1);
         }
     }
-    
+
     return result;
 }
 
-std::string URL::to_string() const {
-    std::string result = scheme + "://" + host;
-    if ((scheme == "http" && port != 80) || (scheme == "https" && port != 443)) {
-        result += ":" + std::to_string(port);
-    }
-    result += path;
-    if (!query.empty()) {
-        result += "?" + query;
-    }
+bool URLView::is_https() const {
+    return iequals(scheme, "https");
+}
+
+URL URLView::to_url() const {
+    URL result;
+    result.scheme.assign(scheme);
+    std::transform(result.scheme.begin(), result.scheme.end(),
+                   result.scheme.begin(), ::tolower);
+    result.host.assign(host);
+    result.port = port;
+    result.path.assign(path);
+    result.query.assign(query);
     return result;
 }
 
@@ -103,12 +215,16 @@ class HTTPClient::Impl {
 public:
     ConnectionPool pool_;
     std::unique_ptr<DNSCache> dns_cache_;
+    std::unique_ptr<DiskCache> disk_cache_;
     std::unique_ptr<RateLimiter> rate_limiter_;
+    PerHostRateLimiter host_rate_limiter_; // per-origin politeness caps
     Statistics stats_;
     
     std::string user_agent_;
     std::chrono::milliseconds default_timeout_;
     bool enable_http2_ = false;
+    bool enable_http3_ = false;
+    bool enable_pipelining_ = false; // HTTP/1.1 pipelining for batch runs
     bool enable_compression_ = true;
     
     Impl() 
@@ -119,14 +235,106 @@ public:
     }
     
     Response execute_request(const Request& req);
+    Response execute_network(const Request& req); // bypasses the disk cache
     Response execute_with_retry(const Request& req);
-    
-private:
+    Response execute_hedged(const Request& req);
+
+    class BatchEngine; // epoll reactor defined below
+
+    // Compiled request template: the invariant part of the serialized request
+    // (Host, user headers, defaults) cached per {host:port, header set} so
+    // batch runs against one host reuse it byte-for-byte instead of
+    // re-serializing and lowercasing headers on every call
+    struct RequestTemplate {
+        HeaderMap headers; // header set prefix was built from
+        std::string user_agent;
+        bool compression = false;
+        std::string prefix; // "Host: ...\r\n" + headers + defaults
+    };
+    std::unordered_map<std::string, RequestTemplate> request_templates_;
+    std::mutex template_mutex_;
+
+    // Shared with the epoll batch engine below
     std::string build_request(const Request& req);
-    Response parse_response(const std::vector<uint8_t>& data, bool enable_decompression);
-        std::vector<uint8_t> read_response(int socket_fd, TLSConnection* tls, std::chrono::milliseconds timeout, const std::string& method);
+    void finalize_body(Response& resp, bool enable_decompression);
+
+    // HTTP/2 routing
+    Response execute_http2(const Request& req, PooledConnection& conn);
+    bool try_http2_batch(const std::vector<Request>& all,
+                         const std::vector<size_t>& indices,
+                         std::vector<Response>& out);
+    bool try_pipeline_batch(const std::vector<Request>& all,
+                            const std::vector<size_t>& indices,
+                            std::vector<Response>& out,
+                            std::vector<size_t>& unanswered);
+    HTTP2Request to_h2_request(const Request& req);
+    Response from_h2_response(HTTP2Response&& h2resp, const Request& req);
+
+    // HTTP/3 routing: hosts whose Alt-Svc advertised h3, learned from
+    // responses so later requests can upgrade without a flag
+    std::unordered_set<std::string> h3_hosts_;
+    std::mutex h3_mutex_;
+
+    bool host_advertises_h3(const std::string& host);
+    void note_alt_svc(const Response& resp, const std::string& host);
+    std::optional<Response> try_http3(const Request& req);
+
+    void follow_redirect_if_needed(const Request& req, Response& resp);
+
+    // Speculative connection warm-up (HTTPClient::preconnect)
+    void preconnect(const std::string& host, int port, int n);
+
+    ~Impl() {
+        for (auto& t : background_threads_) {
+            if (t.thread.joinable()) {
+                t.thread.join();
+            }
+        }
+    }
+
+private:
+    // Preconnect warm-ups and losing hedge attempts run out here. Each entry
+    // flags itself done when its task returns; the next spawn joins and
+    // drops the finished ones, so a long-running client with hedging on
+    // holds a handful of live entries instead of an ever-growing vector of
+    // unjoined threads. The destructor joins whatever is still running.
+    struct BackgroundThread {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::vector<BackgroundThread> background_threads_;
+    std::mutex background_mutex_;
+
+    template <typename Fn>
+    void spawn_background(Fn&& fn) {
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread([fn = std::forward<Fn>(fn), done]() mutable {
+            fn();
+            done->store(true, std::memory_order_release);
+        });
+
+        std::lock_guard<std::mutex> lock(background_mutex_);
+        // Reap completed entries — their joins return immediately
+        for (auto it = background_threads_.begin();
+             it != background_threads_.end();) {
+            if (it->done->load(std::memory_order_acquire)) {
+                it->thread.join();
+                it = background_threads_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        background_threads_.push_back({std::move(thread), std::move(done)});
+    }
+
+    bool establish_pooled(const std::string& host, int port, bool use_tls);
+
+    Response read_response(int socket_fd, TLSConnection* tls, std::chrono::milliseconds timeout,
+                           const std::string& method, bool enable_decompression,
+                           const BodySink* sink = nullptr);
     
     int connect_with_dns_cache(const std::string& host, int port);
+    bool send_body_file(int socket_fd, TLSConnection* tls, const std::string& path);
 };
 
 int HTTPClient::Impl::connect_with_dns_cache(const std::string& host, int port) {
@@ -179,11 +387,69 @@ int HTTPClient::Impl::connect_with_dns_cache(const std::string& host, int port)
     return he.connect(std::chrono::milliseconds(5000));
 }
 
+// Establish one connection through the normal setup path (DNS cache or Happy
+// Eyeballs, then TLS + ALPN) and park it idle in the pool for a later request
+bool HTTPClient::Impl::establish_pooled(const std::string& host, int port,
+                                        bool use_tls) {
+    int fd = connect_with_dns_cache(host, port);
+    if (fd < 0) {
+        stats_.record_error("preconnect_failed");
+        return false;
+    }
+
+    auto conn = std::make_shared<PooledConnection>();
+    conn->socket_fd = fd;
+    conn->in_use = true;
+
+    if (use_tls) {
+        conn->tls = std::make_unique<TLSConnection>(fd, host);
+#ifdef HAVE_NGHTTP2
+        if (enable_http2_) {
+            conn->tls->enable_alpn_http2();
+        }
+#endif
+        if (!conn->tls->handshake()) {
+            ::close(fd);
+            stats_.record_error("preconnect_tls_failed");
+            return false;
+        }
+        if (conn->tls->negotiated_http2()) {
+            conn->h2 = std::make_unique<HTTP2Session>(conn->tls.get(), host);
+            if (!conn->h2->init()) {
+                ::close(fd);
+                stats_.record_error("preconnect_h2_failed");
+                return false;
+            }
+        }
+    }
+
+    stats_.record_connection(false);
+    pool_.release(host, port, conn); // parks it idle, keyed by (host, port, tls)
+    return true;
+}
+
+void HTTPClient::Impl::preconnect(const std::string& host, int port, int n) {
+    bool use_tls = (port != 80);
+    for (int i = 0; i < n; ++i) {
+        spawn_background([this, host, port, use_tls]() {
+            establish_pooled(host, port, use_tls);
+        });
+    }
+}
+
 std::string HTTPClient::Impl::build_request(const Request& req) {
+    bool compression = req.enable_compression && enable_compression_;
+
+    std::string key;
+    key.reserve(req.url.host.size() + 8);
+    key += req.url.host;
+    key += ':';
+    key += std::to_string(req.url.port);
+
     std::string result;
     result.reserve(512); // Pre-allocate
-    
-    // Request line
+
+    // Request line — the only part that varies with the path
     result += req.method;
     result += " ";
     result += req.url.path;
@@ -192,87 +458,248 @@ std::string HTTPClient::Impl::build_request(const Request& req) {
         result += req.url.query;
     }
     result += " HTTP/1.1\r\n";
-    
-    // Host header
-    result += "Host: ";
-    result += req.url.host;
-    if ((req.url.scheme == "http" && req.url.port != 80) ||
-        (req.url.scheme == "https" && req.url.port != 443)) {
-        result += ":";
-        result += std::to_string(req.url.port);
+
+    {
+        std::lock_guard<std::mutex> lock(template_mutex_);
+        RequestTemplate& tmpl = request_templates_[key];
+
+        // Rebuild the cached prefix only when the header set (ignoring
+        // per-request volatile headers) or client config changed
+        bool valid = !tmpl.prefix.empty() &&
+                     tmpl.compression == compression &&
+                     tmpl.user_agent == user_agent_ &&
+                     tmpl.headers.size() == req.headers.size();
+        if (valid) {
+            auto a = tmpl.headers.begin();
+            auto b = req.headers.begin();
+            for (; a != tmpl.headers.end(); ++a, ++b) {
+                const auto [tname, tvalue] = *a;
+                const auto [rname, rvalue] = *b;
+                if (tname != rname ||
+                    (!is_volatile_header(tname) && tvalue != rvalue)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+
+        if (!valid) {
+            std::string& prefix = tmpl.prefix;
+            prefix.clear();
+            prefix.reserve(384);
+
+            // Host header
+            prefix += "Host: ";
+            prefix += req.url.host;
+            if ((req.url.scheme == "http" && req.url.port != 80) ||
+                (req.url.scheme == "https" && req.url.port != 443)) {
+                prefix += ":";
+                prefix += std::to_string(req.url.port);
+            }
+            prefix += "\r\n";
+
+            // Check which headers are already set — no lowercase copies
+            bool has_user_agent = false;
+            bool has_connection = false;
+            bool has_accept = false;
+            bool has_accept_encoding = false;
+
+            for (const auto& [name, value] : req.headers) {
+                if (is_volatile_header(name)) continue; // appended per request
+
+                if (iequals(name, "user-agent")) has_user_agent = true;
+                if (iequals(name, "connection")) has_connection = true;
+                if (iequals(name, "accept")) has_accept = true;
+                if (iequals(name, "accept-encoding")) has_accept_encoding = true;
+
+                prefix += name;
+                prefix += ": ";
+                prefix += value;
+                prefix += "\r\n";
+            }
+
+            // Add default headers
+            if (!has_user_agent) {
+                prefix += "User-Agent: ";
+                prefix += user_agent_;
+                prefix += "\r\n";
+            }
+
+            if (!has_connection) {
+                prefix += "Connection: keep-alive\r\n";
+            }
+
+            if (!has_accept) {
+                prefix += "Accept: */*\r\n";
+            }
+
+            if (!has_accept_encoding && compression) {
+                prefix += "Accept-Encoding: ";
+                prefix += Compression::get_accept_encoding_header();
+                prefix += "\r\n";
+            }
+
+            tmpl.headers = req.headers;
+            tmpl.user_agent = user_agent_;
+            tmpl.compression = compression;
+        }
+
+        result += tmpl.prefix;
     }
-    result += "\r\n";
-    
-    // Check which headers are already set
-    bool has_user_agent = false;
-    bool has_connection = false;
-    bool has_accept = false;
-    bool has_accept_encoding = false;
-    
-    for (const auto& [key, value] : req.headers) {
-        std::string lower_key = key;
-        std::transform(lower_key.begin(), lower_key.end(), lower_key.begin(), ::tolower);
-        
-        if (lower_key == "user-agent") has_user_agent = true;
-        if (lower_key == "connection") has_connection = true;
-        if (lower_key == "accept") has_accept = true;
-        if (lower_key == "accept-encoding") has_accept_encoding = true;
-        
-        result += key;
+
+    // Per-request deltas on top of the cached prefix
+    bool has_content_length = false;
+    for (const auto& [name, value] : req.headers) {
+        if (!is_volatile_header(name)) continue;
+        if (iequals(name, "content-length")) has_content_length = true;
+        result += name;
         result += ": ";
         result += value;
         result += "\r\n";
     }
-    
-    // Add default headers
-    if (!has_user_agent) {
-        result += "User-Agent: ";
-        result += user_agent_;
-        result += "\r\n";
-    }
-    
-    if (!has_connection) {
-        result += "Connection: keep-alive\r\n";
+
+    if (!has_content_length) {
+        if (!req.body_file.empty()) {
+            struct stat st{};
+            if (::stat(req.body_file.c_str(), &st) == 0) {
+                result += "Content-Length: ";
+                result += std::to_string((size_t)st.st_size);
+                result += "\r\n";
+            }
+        } else if (!req.body.empty()) {
+            result += "Content-Length: ";
+            result += std::to_string(req.body.size());
+            result += "\r\n";
+        }
     }
-    
-    if (!has_accept) {
-        result += "Accept: */*\r\n";
+
+    result += "\r\n";
+
+    return result;
+}
+
+// Stream a request body from disk with constant memory: sendfile() moves
+// pages kernel-side on plain TCP; TLS reads 64KB slices and pushes them
+// through the record layer
+bool HTTPClient::Impl::send_body_file(int socket_fd, TLSConnection* tls,
+                                      const std::string& path) {
+    int in_fd = ::open(path.c_str(), O_RDONLY);
+    if (in_fd < 0) {
+        return false;
     }
-    
-    if (!has_accept_encoding && req.enable_compression && enable_compression_) {
-        result += "Accept-Encoding: ";
-        result += Compression::get_accept_encoding_header();
-        result += "\r\n";
+
+    struct stat st{};
+    if (::fstat(in_fd, &st) != 0) {
+        ::close(in_fd);
+        return false;
     }
-    
-    if (!req.body.empty()) {
-        result += "Content-Length: ";
-        result += std::to_string(req.body.size());
-        result += "\r\n";
+    size_t remaining = (size_t)st.st_size;
+
+    bool ok = true;
+    if (!tls) {
+        off_t offset = 0;
+        while (remaining > 0) {
+            ssize_t n = ::sendfile(socket_fd, in_fd, &offset, remaining);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            remaining -= (size_t)n;
+        }
+    } else {
+        uint8_t buf[65536];
+        while (remaining > 0) {
+            ssize_t n = ::read(in_fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = false; // short read — file shrank underneath us
+                break;
+            }
+            ssize_t sent_total = 0;
+            while (sent_total < n) {
+                ssize_t s = tls->send(buf + sent_total, (size_t)(n - sent_total));
+                if (s <= 0) {
+                    ok = false;
+                    break;
+                }
+                sent_total += s;
+            }
+            if (!ok) break;
+            remaining -= (size_t)n;
+        }
     }
-    
-    result += "\r\n";
-    
-    return result;
+
+    ::close(in_fd);
+    return ok;
 }
 
-std::vector<uint8_t> HTTPClient::Impl::read_response(
-    int socket_fd, TLSConnection* tls, std::chrono::milliseconds inactivity_timeout, const std::string& method) {
-    
-    std::vector<uint8_t> response;
-    response.reserve(65536);
-    
+Response HTTPClient::Impl::read_response(
+    int socket_fd, TLSConnection* tls, std::chrono::milliseconds inactivity_timeout,
+    const std::string& method, bool enable_decompression, const BodySink* sink) {
+
     uint8_t buffer[131072]; // 128KB read buffer for large downloads
-    bool headers_complete = false;
-    size_t content_length = 0;
-    bool chunked = false;
-    size_t headers_end = 0;
     bool first_byte_received = false;
-    
+
+    HTTP1Parser parser;
+    parser.set_head_request(method == "HEAD");
+
+    // Streaming mode: once the headers are parsed, 2xx body bytes are handed
+    // to the sink instead of accumulating in Response::body; compressed
+    // bodies are routed through an incremental decompressor on the way, so
+    // decompression overlaps the download.
+    bool streamed = false;
+    std::unique_ptr<StreamingDecompressor> decompressor;
+    size_t sink_delivered = 0; // bytes actually handed to the caller's sink
+    StreamingDecompressor::OutputFn user_deliver;
+
+    if (sink && *sink) {
+        user_deliver = [&](const uint8_t* data, size_t len) {
+            sink_delivered += len;
+            return (*sink)(data, len);
+        };
+
+        parser.set_headers_callback([&]() {
+            const Response& r = parser.response();
+            // Redirect/error bodies stay buffered
+            if (r.status_code < 200 || r.status_code >= 300) {
+                return;
+            }
+
+            auto encoding = r.headers.get("content-encoding");
+            if (encoding && (encoding->empty() || *encoding == "identity")) {
+                encoding = std::nullopt;
+            }
+
+            if (encoding) {
+                // Decompress incrementally on the way to the sink; an unknown
+                // coding falls back to the buffered path where finalize_body
+                // decompresses the whole body
+                auto ctype = Compression::detect_from_header(std::string(*encoding));
+                decompressor = std::make_unique<StreamingDecompressor>(ctype);
+                if (!decompressor->valid()) {
+                    decompressor.reset();
+                    return;
+                }
+                parser.set_body_handler([&](const uint8_t* data, size_t len) {
+                    return decompressor->feed(data, len, user_deliver);
+                });
+            } else {
+                parser.set_body_handler([&](const uint8_t* data, size_t len) {
+                    return user_deliver(data, len);
+                });
+            }
+            streamed = true;
+        });
+    }
+
     auto request_start  = std::chrono::steady_clock::now();
     auto last_data_time = request_start; // reset every time data arrives
-    
-    while (true) {
+    auto status = HTTP1Parser::Status::NeedMore;
+    bool peer_closed = false;
+    uint64_t body_start_us = 0; // set at first byte when tracing
+
+    while (status == HTTP1Parser::Status::NeedMore) {
         // INACTIVITY timeout: abort only if no data arrives for inactivity_timeout ms
         // This allows unlimited total download time as long as data keeps flowing
         auto now  = std::chrono::steady_clock::now();
@@ -280,238 +707,483 @@ std::vector<uint8_t> HTTPClient::Impl::read_response(
         if (idle >= inactivity_timeout) {
             break; // stalled / dead connection
         }
-        
+
         ssize_t n;
         if (tls) {
             n = tls->recv(buffer, sizeof(buffer));
         } else {
             n = ::recv(socket_fd, buffer, sizeof(buffer), 0);
         }
-        
+
         if (n < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
                 continue;
             }
+            peer_closed = true;
             break; // real error
         }
-        
+
         if (n == 0) {
-            break; // server closed connection cleanly — download complete
+            peer_closed = true;
+            break; // server closed connection cleanly
         }
-        
+
         // Data received — reset inactivity timer
         last_data_time = std::chrono::steady_clock::now();
-        
+
         // Record first byte timing once
         if (!first_byte_received) {
             first_byte_received = true;
             auto fb = std::chrono::duration_cast<std::chrono::milliseconds>(
                 last_data_time - request_start);
             stats_.record_first_byte(fb);
+            if (trace::enabled()) {
+                trace::emit("ttfb", steady_us(request_start), trace::now_us());
+                body_start_us = trace::now_us();
+            }
         }
-        
-        response.insert(response.end(), buffer, buffer + n);
+
         g_downloaded.fetch_add(n); // Directly update global atomic
-        
-        // Parse headers on the first pass
-        if (!headers_complete) {
-            for (size_t i = 0; i + 3 < response.size(); ++i) {
-                if (response[i] == '\r' && response[i+1] == '\n' &&
-                    response[i+2] == '\r' && response[i+3] == '\n') {
-                    headers_complete = true;
-                    headers_end = i + 4;
-                    
-                    size_t pos = 0;
-                    while (pos < headers_end && response[pos] != '\n') pos++;
-                    pos++;
-                    
-                    while (pos < headers_end) {
-                        size_t line_end = pos;
-                        while (line_end < headers_end && response[line_end] != '\n') line_end++;
-                        if (line_end == pos || response[pos] == '\r') break;
-                        
-                        size_t colon = pos;
-                        while (colon < line_end && response[colon] != ':') colon++;
-                        
-                        if (colon < line_end) {
-                            std::string key(response.begin() + pos, response.begin() + colon);
-                            std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-                            
-                            size_t vs = colon + 1;
-                            while (vs < line_end && (response[vs]==' '||response[vs]=='\t')) vs++;
-                            size_t ve = line_end;
-                            if (ve > 0 && response[ve-1] == '\r') ve--;
-                            
-                            std::string value(response.begin() + vs, response.begin() + ve);
-                            
-                            if (key == "content-length") {
-                                content_length = 0; for (char c : value) { if (c >= '0' && c <= '9') content_length = content_length * 10 + (c - '0'); else break; }
-                            } else if (key == "transfer-encoding" &&
-                                       value.find("chunked") != std::string::npos) {
-                                chunked = true;
-                            }
-                        }
-                        pos = line_end + 1;
-                    }
-                    break;
-                }
+        status = parser.feed(buffer, static_cast<size_t>(n));
+    }
+
+    if (status == HTTP1Parser::Status::NeedMore && peer_closed) {
+        parser.finish_eof(); // completes an unknown-length body
+    }
+    if (body_start_us) {
+        trace::emit("body", body_start_us, trace::now_us());
+    }
+
+    Response resp = parser.take_response();
+
+    if (!parser.headers_complete()) {
+        resp.status_code = 0; // nothing parseable arrived
+        return resp;
+    }
+
+    if (streamed) {
+        resp.bytes_received = sink_delivered;
+        resp.was_compressed = (decompressor != nullptr);
+    } else {
+        finalize_body(resp, enable_decompression);
+    }
+
+    return resp;
+}
+
+// Post-read fixup for buffered bodies: record the size and decompress
+// according to Content-Encoding. Streamed bodies are decompressed on the fly
+// and never pass through here.
+void HTTPClient::Impl::finalize_body(Response& resp, bool enable_decompression) {
+    resp.bytes_received = resp.body.size();
+
+    if (!enable_decompression || resp.body.empty()) {
+        return;
+    }
+
+    for (const auto& [name, value] : resp.headers) {
+        if (!iequals(name, "content-encoding")) continue;
+
+        auto type = Compression::detect_from_header(std::string(value));
+        if (type != CompressionType::None) {
+            trace::Span span("decompress");
+            auto decompressed = Compression::decompress(resp.body, type);
+            if (decompressed) {
+                resp.body = *decompressed;
+                resp.was_compressed = true;
             }
         }
-        
-        if (headers_complete) {
-            // If method is HEAD, stop reading after headers
-            if (method == "HEAD") {
-                goto read_done;
+        break;
+    }
+}
+
+void HTTPClient::Impl::follow_redirect_if_needed(const Request& req, Response& resp) {
+    if (req.follow_redirects && resp.status_code >= 300 && resp.status_code < 400) {
+        // Case-insensitive lookup covers HTTP/2's lowercase header names too
+        auto location = resp.headers.get("Location");
+        if (location && req.max_redirects > 0) {
+            // Validate the Location header zero-copy; own it only when valid
+            auto new_url = URLView::parse(*location);
+            if (new_url) {
+                Request new_req = req;
+                new_req.url = new_url->to_url();
+                new_req.max_redirects = req.max_redirects - 1;
+                resp = execute_request(new_req);
+                resp.redirect_count++;
             }
-            
-            if (chunked) {
-                // Search for terminal chunk pattern: "0\r\n\r\n"
-                for (size_t i = headers_end; i + 4 < response.size(); ++i) {
-                    if (response[i]   == '0' && response[i+1] == '\r' &&
-                        response[i+2] == '\n' && response[i+3] == '\r' &&
-                        response[i+4] == '\n') {
-                        goto read_done;
-                    }
-                }
-            } else if (content_length > 0) {
-                if (response.size() >= headers_end + content_length) {
-                    goto read_done;
+        }
+    }
+}
+
+HTTP2Request HTTPClient::Impl::to_h2_request(const Request& req) {
+    HTTP2Request h2req;
+    h2req.method = req.method;
+    h2req.path = req.url.path;
+    if (!req.url.query.empty()) {
+        h2req.path += "?" + req.url.query;
+    }
+    h2req.headers = req.headers;
+    h2req.body = req.body;
+
+    if (!req.headers.contains("user-agent")) {
+        h2req.headers.add("user-agent", user_agent_);
+    }
+    if (!req.headers.contains("accept")) {
+        h2req.headers.add("accept", "*/*");
+    }
+    if (!req.headers.contains("accept-encoding") &&
+        req.enable_compression && enable_compression_) {
+        h2req.headers.add("accept-encoding", Compression::get_accept_encoding_header());
+    }
+
+    return h2req;
+}
+
+Response HTTPClient::Impl::from_h2_response(HTTP2Response&& h2resp, const Request& req) {
+    Response resp;
+    resp.status_code = h2resp.status_code;
+    resp.headers = std::move(h2resp.headers);
+    resp.body = std::move(h2resp.body);
+    resp.used_http2 = true;
+    resp.bytes_received = resp.body.size();
+
+    if (req.enable_compression && !resp.body.empty()) {
+        auto encoding = resp.headers.get("content-encoding");
+        if (encoding) {
+            auto type = Compression::detect_from_header(std::string(*encoding));
+            if (type != CompressionType::None) {
+                auto decompressed = Compression::decompress(resp.body, type);
+                if (decompressed) {
+                    resp.body = *decompressed;
+                    resp.was_compressed = true;
                 }
             }
-            // else: unknown length, keep reading until server closes or inactivity
         }
     }
-    read_done:
-    
-    return response;
+
+    if (req.body_sink && resp.status_code >= 200 && resp.status_code < 300 &&
+        !resp.body.empty()) {
+        req.body_sink(resp.body.data(), resp.body.size());
+        resp.body.clear();
+        resp.body.shrink_to_fit();
+    }
+
+    return resp;
 }
 
-Response HTTPClient::Impl::parse_response(const std::vector<uint8_t>& data, bool enable_decompression) {
-    Response resp;
-    
-    if (data.empty()) {
+Response HTTPClient::Impl::execute_http2(const Request& req, PooledConnection& conn) {
+    auto h2resp = conn.h2->request(to_h2_request(req));
+    if (!h2resp) {
+        Response resp;
         resp.status_code = 0;
+        stats_.record_error("http2_request_failed");
         return resp;
     }
-    
-    // Find end of headers
-    size_t headers_end = 0;
-    for (size_t i = 0; i + 3 < data.size(); ++i) {
-        if (data[i] == '\r' && data[i+1] == '\n' &&
-            data[i+2] == '\r' && data[i+3] == '\n') {
-            headers_end = i + 4;
-            break;
+    return from_h2_response(std::move(*h2resp), req);
+}
+
+bool HTTPClient::Impl::host_advertises_h3(const std::string& host) {
+    std::lock_guard<std::mutex> lock(h3_mutex_);
+    return h3_hosts_.count(host) > 0;
+}
+
+void HTTPClient::Impl::note_alt_svc(const Response& resp, const std::string& host) {
+    for (const auto& [name, value] : resp.headers) {
+        if (iequals(name, "alt-svc") &&
+            value.find("h3") != std::string::npos) {
+            std::lock_guard<std::mutex> lock(h3_mutex_);
+            h3_hosts_.insert(host);
+            return;
         }
     }
-    
-    if (headers_end == 0) {
-        resp.status_code = 0;
-        return resp;
+}
+
+std::optional<Response> HTTPClient::Impl::try_http3(const Request& req) {
+    HTTP3Session h3(req.url.host, req.url.port);
+    if (!h3.init()) {
+        return std::nullopt; // no QUIC transport — caller falls back to TCP
     }
-    
-    // Parse status line
-    size_t pos = 0;
-    while (pos < headers_end && data[pos] != ' ') pos++; // Skip HTTP version
-    pos++;
-    
-    // Parse status code
-    size_t code_start = pos;
-    while (pos < headers_end && data[pos] >= '0' && data[pos] <= '9') pos++;
-    resp.status_code = std::stoi(std::string(data.begin() + code_start, data.begin() + pos));
-    
-    // Parse status message
-    pos++; // Skip space
-    size_t msg_start = pos;
-    while (pos < headers_end && data[pos] != '\r') pos++;
-    resp.status_message = std::string(data.begin() + msg_start, data.begin() + pos);
-    pos += 2; // Skip \r\n
-    
-    // Parse headers
-    CompressionType compression_type = CompressionType::None;
-    
-    while (pos < headers_end) {
-        size_t line_end = pos;
-        while (line_end < headers_end && data[line_end] != '\n') line_end++;
-        
-        if (line_end == pos || data[pos] == '\r') break;
-        
-        size_t colon = pos;
-        while (colon < line_end && data[colon] != ':') colon++;
-        
-        if (colon < line_end) {
-            std::string key(data.begin() + pos, data.begin() + colon);
-            
-            size_t val_start = colon + 1;
-            while (val_start < line_end && (data[val_start] == ' ' || data[val_start] == '\t')) {
-                val_start++;
+
+    // The header-set logic is identical to h2, so reuse its builder
+    HTTP2Request tmpl = to_h2_request(req);
+    HTTP3Request h3req;
+    h3req.method = std::move(tmpl.method);
+    h3req.path = std::move(tmpl.path);
+    h3req.headers = std::move(tmpl.headers);
+    h3req.body = std::move(tmpl.body);
+
+    auto h3resp = h3.request(h3req);
+    if (!h3resp) {
+        stats_.record_error("http3_request_failed");
+        return std::nullopt;
+    }
+
+    HTTP2Response bridge;
+    bridge.status_code = h3resp->status_code;
+    bridge.headers = std::move(h3resp->headers);
+    bridge.body = std::move(h3resp->body);
+    Response resp = from_h2_response(std::move(bridge), req);
+    resp.used_http2 = false;
+    return resp;
+}
+
+bool HTTPClient::Impl::try_http2_batch(const std::vector<Request>& all,
+                                       const std::vector<size_t>& indices,
+                                       std::vector<Response>& out) {
+#ifndef HAVE_NGHTTP2
+    (void)all; (void)indices; (void)out;
+    return false; // without nghttp2 everything goes through HTTP/1.1
+#else
+    const Request& first = all[indices[0]];
+    auto start = std::chrono::steady_clock::now();
+
+    auto conn = pool_.acquire(first.url.host, first.url.port, true);
+    if (conn && (!conn->h2 || !conn->h2->is_alive())) {
+        // Pooled HTTP/1.1 connection — leave it for the epoll engine
+        pool_.release(first.url.host, first.url.port, conn);
+        conn.reset();
+    }
+
+    if (!conn) {
+        HappyEyeballs he(first.url.host, first.url.port);
+        int fd = he.connect(std::chrono::milliseconds(10000));
+        if (fd < 0) {
+            return false;
+        }
+
+        conn = std::make_shared<PooledConnection>();
+        conn->socket_fd = fd;
+        conn->in_use = true;
+        conn->tls = std::make_unique<TLSConnection>(fd, first.url.host);
+        conn->tls->enable_alpn_http2();
+        if (!conn->tls->handshake()) {
+            ::close(fd);
+            return false;
+        }
+        if (!conn->tls->negotiated_http2()) {
+            // Server only speaks HTTP/1.1 — keep the warm connection around
+            // and let the epoll engine use it
+            pool_.release(first.url.host, first.url.port, conn);
+            return false;
+        }
+        conn->h2 = std::make_unique<HTTP2Session>(conn->tls.get(), first.url.host);
+        if (!conn->h2->init()) {
+            ::close(fd);
+            return false;
+        }
+        stats_.record_connection(false);
+    } else {
+        stats_.record_connection(true);
+    }
+
+    std::vector<HTTP2Request> h2_requests;
+    h2_requests.reserve(indices.size());
+    for (size_t idx : indices) {
+        h2_requests.push_back(to_h2_request(all[idx]));
+    }
+
+    auto h2_responses = conn->h2->batch_request(h2_requests);
+
+    if (conn->h2->is_alive()) {
+        pool_.release(first.url.host, first.url.port, conn);
+    } else if (conn->socket_fd >= 0) {
+        ::close(conn->socket_fd);
+    }
+
+    if (h2_responses.size() != indices.size()) {
+        return false; // session died mid-batch; fall back to HTTP/1.1
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const Request& req = all[indices[i]];
+        Response resp = from_h2_response(std::move(h2_responses[i]), req);
+        resp.elapsed_time = elapsed; // streams complete together when multiplexed
+        stats_.record_request(resp.elapsed_time, resp.bytes_received, req.url.host);
+        stats_.record_protocol("h2");
+        follow_redirect_if_needed(req, resp);
+        out[indices[i]] = std::move(resp);
+    }
+    return true;
+#endif // HAVE_NGHTTP2
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// HTTP/1.1 pipelining
+//   Serializes a same-host run of idempotent requests back-to-back on one
+//   pooled connection and reads the responses in order, so the whole run
+//   costs one round trip of queueing instead of one per request. Opt-in
+//   (enable_pipelining) because intermediaries that mishandle pipelined
+//   requests still exist; any failure falls back to the epoll engine.
+// ─────────────────────────────────────────────────────────────────────────────
+bool HTTPClient::Impl::try_pipeline_batch(const std::vector<Request>& all,
+                                          const std::vector<size_t>& indices,
+                                          std::vector<Response>& out,
+                                          std::vector<size_t>& unanswered) {
+    const Request& first = all[indices[0]];
+    bool use_tls = (first.url.scheme == "https");
+    auto start = std::chrono::steady_clock::now();
+
+    auto conn = pool_.acquire(first.url.host, first.url.port, use_tls);
+    if (conn && conn->h2) {
+        // Multiplexed session — streams beat pipelining, leave it alone
+        pool_.release(first.url.host, first.url.port, conn);
+        return false;
+    }
+
+    if (!conn) {
+        if (!establish_pooled(first.url.host, first.url.port, use_tls)) {
+            return false;
+        }
+        conn = pool_.acquire(first.url.host, first.url.port, use_tls);
+        if (!conn) {
+            return false;
+        }
+        if (conn->h2) {
+            // ALPN picked h2 after all — let the h2 path multiplex it
+            pool_.release(first.url.host, first.url.port, conn);
+            return false;
+        }
+    } else {
+        stats_.record_connection(true);
+    }
+
+    // One buffer, one write: every request is on the wire before the first
+    // response is read
+    std::string wire;
+    for (size_t idx : indices) {
+        wire += build_request(all[idx]);
+    }
+
+    size_t sent_total = 0;
+    while (sent_total < wire.size()) {
+        ssize_t n;
+        if (conn->tls) {
+            n = conn->tls->send(wire.data() + sent_total, wire.size() - sent_total);
+        } else {
+            n = ::send(conn->socket_fd, wire.data() + sent_total,
+                       wire.size() - sent_total, MSG_NOSIGNAL);
+        }
+        if (n <= 0) {
+            ::close(conn->socket_fd);
+            return false;
+        }
+        sent_total += (size_t)n;
+    }
+
+    // Read responses in request order. A read often ends inside the next
+    // message, so bytes past one parser's end carry over to the next via
+    // last_feed_consumed().
+    uint8_t buffer[65536];
+    std::string pending;
+    bool conn_usable = true;
+
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const Request& req = all[indices[k]];
+        HTTP1Parser parser;
+        parser.set_head_request(req.method == "HEAD");
+        auto status = HTTP1Parser::Status::NeedMore;
+
+        if (!pending.empty()) {
+            std::string carry;
+            carry.swap(pending);
+            status = parser.feed(
+                reinterpret_cast<const uint8_t*>(carry.data()), carry.size());
+            size_t used = parser.last_feed_consumed();
+            if (used < carry.size()) {
+                pending.assign(carry, used, std::string::npos);
             }
-            size_t val_end = line_end;
-            if (val_end > 0 && data[val_end - 1] == '\r') val_end--;
-            
-            std::string value(data.begin() + val_start, data.begin() + val_end);
-            resp.headers[key] = value;
-            
-            // Check for compression
-            if (enable_decompression) {
-                std::string lower_key = key;
-                std::transform(lower_key.begin(), lower_key.end(), lower_key.begin(), ::tolower);
-                if (lower_key == "content-encoding") {
-                    compression_type = Compression::detect_from_header(value);
+        }
+
+        auto last_data_time = std::chrono::steady_clock::now();
+        bool peer_closed = false;
+
+        while (status == HTTP1Parser::Status::NeedMore) {
+            auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - last_data_time);
+            if (idle >= req.timeout) {
+                break; // stalled / dead connection
+            }
+
+            ssize_t n;
+            if (conn->tls) {
+                n = conn->tls->recv(buffer, sizeof(buffer));
+            } else {
+                n = ::recv(conn->socket_fd, buffer, sizeof(buffer), 0);
+            }
+
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    continue;
                 }
+                peer_closed = true;
+                break;
+            }
+            if (n == 0) {
+                peer_closed = true;
+                break;
+            }
+
+            last_data_time = std::chrono::steady_clock::now();
+            g_downloaded.fetch_add(n);
+            status = parser.feed(buffer, static_cast<size_t>(n));
+            size_t used = parser.last_feed_consumed();
+            if (used < static_cast<size_t>(n)) {
+                pending.append(reinterpret_cast<const char*>(buffer) + used,
+                               static_cast<size_t>(n) - used);
             }
         }
-        
-        pos = line_end + 1;
-    }
-    
-    // Extract body
-    if (headers_end < data.size()) {
-        auto it = resp.headers.find("Transfer-Encoding");
-        if (it != resp.headers.end() && it->second.find("chunked") != std::string::npos) {
-            // Decode chunked encoding
-            size_t chunk_pos = headers_end;
-            while (chunk_pos < data.size()) {
-                size_t line_end = chunk_pos;
-                while (line_end + 1 < data.size() && 
-                       !(data[line_end] == '\r' && data[line_end+1] == '\n')) {
-                    line_end++;
-                }
-                
-                if (line_end + 1 >= data.size()) break;
-                
-                std::string chunk_size_str(data.begin() + chunk_pos, data.begin() + line_end);
-                size_t chunk_size = std::stoull(chunk_size_str, nullptr, 16);
-                
-                if (chunk_size == 0) break;
-                
-                chunk_pos = line_end + 2;
-                
-                if (chunk_pos + chunk_size <= data.size()) {
-                    resp.body.insert(resp.body.end(), 
-                                    data.begin() + chunk_pos,
-                                    data.begin() + chunk_pos + chunk_size);
-                }
-                
-                chunk_pos += chunk_size + 2;
+
+        if (status == HTTP1Parser::Status::NeedMore && peer_closed) {
+            status = parser.finish_eof();
+        }
+
+        if (status != HTTP1Parser::Status::Complete || !parser.headers_complete()) {
+            if (k == 0) {
+                // Nothing answered — run the whole group through the epoll
+                // engine instead
+                ::close(conn->socket_fd);
+                return false;
             }
-        } else {
-            resp.body.assign(data.begin() + headers_end, data.end());
+            // Mid-pipeline loss: a server closing its keep-alive connection
+            // after N responses is routine, not a failure. The already-parsed
+            // responses stand; the rest go back to the caller to run through
+            // the epoll engine as ordinary requests.
+            for (size_t j = k; j < indices.size(); ++j) {
+                unanswered.push_back(indices[j]);
+            }
+            ::close(conn->socket_fd);
+            return true;
         }
-    }
-    
-    resp.bytes_received = resp.body.size();
-    
-    // Decompress if needed
-    if (enable_decompression && compression_type != CompressionType::None && !resp.body.empty()) {
-        auto decompressed = Compression::decompress(resp.body, compression_type);
-        if (decompressed) {
-            resp.body = *decompressed;
-            resp.was_compressed = true;
+
+        Response resp = parser.take_response();
+        finalize_body(resp, req.enable_compression);
+        resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        stats_.record_request(resp.elapsed_time, resp.bytes_received, req.url.host);
+        stats_.record_protocol("http/1.1");
+        note_alt_svc(resp, req.url.host);
+        follow_redirect_if_needed(req, resp);
+
+        // "Connection: close" ends reuse; anything still unanswered surfaces
+        // as truncation on the next iteration
+        auto conn_hdr = resp.headers.get("connection");
+        if (conn_hdr && iequals(*conn_hdr, "close")) {
+            conn_usable = false;
         }
+        out[indices[k]] = std::move(resp);
     }
-    
-    return resp;
+
+    if (conn_usable) {
+        pool_.release(first.url.host, first.url.port, conn);
+    } else if (conn->socket_fd >= 0) {
+        ::close(conn->socket_fd);
+    }
+    return true;
 }
 
 Response HTTPClient::Impl::execute_with_retry(const Request& req) {
@@ -534,26 +1206,197 @@ Response HTTPClient::Impl::execute_with_retry(const Request& req) {
             if (req.exponential_backoff) {
                 delay *= (1 << (attempts - 1)); // 2^(attempts-1)
             }
-            
-            std::this_thread::sleep_for(delay);
-            stats_.record_error("retry");
+            
+            std::this_thread::sleep_for(delay);
+            stats_.record_error("retry");
+        }
+    }
+    
+    Response resp;
+    resp.status_code = 0;
+    stats_.record_error("max_retries_exceeded");
+    return resp;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Hedged execution
+//   The primary attempt runs on a background thread. If it neither answers
+//   nor fails within the hedge delay, a duplicate goes out on a second
+//   connection and the first usable response wins; a fast failure fires the
+//   duplicate immediately, which makes this a sleep-free retry as well. The
+//   losing attempt drains in the background and reparks its connection.
+// ─────────────────────────────────────────────────────────────────────────────
+Response HTTPClient::Impl::execute_hedged(const Request& req) {
+    if (req.body_sink) {
+        // Both attempts would stream into the same sink at once — and the
+        // loser keeps feeding it after the winner returns, when the caller
+        // may have torn the sink down. Run the attempts buffered and push
+        // the winner's body through the sink exactly once.
+        Request buffered = req;
+        buffered.body_sink = nullptr;
+        Response resp = execute_hedged(buffered);
+        if (!resp.body.empty()) {
+            req.body_sink(resp.body.data(), resp.body.size());
+            resp.body.clear();
+            resp.body.shrink_to_fit();
+        }
+        return resp;
+    }
+
+    auto delay = req.hedge_delay;
+    if (delay.count() == 0) {
+        delay = stats_.latency_percentile(0.95);
+        if (delay.count() == 0) {
+            delay = std::chrono::milliseconds(1000); // no history yet
+        }
+    }
+
+    struct HedgeState {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int outstanding = 0;
+        bool finished = false; // a usable response is in resp
+        Response resp;         // winner, or the last failure if none won
+    };
+    auto state = std::make_shared<HedgeState>();
+
+    auto fire = [this, state](Request attempt) {
+        attempt.enable_hedging = false;
+        Response r = execute_request(attempt);
+        bool usable = r.status_code > 0 && r.status_code < 500;
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->outstanding--;
+        if (!state->finished) {
+            if (usable) {
+                state->finished = true;
+                state->resp = std::move(r);
+            } else if (state->outstanding == 0) {
+                state->resp = std::move(r); // everyone lost — report this one
+            }
+        }
+        state->cv.notify_all();
+    };
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->outstanding = 1;
+    spawn_background([fire, req]() { fire(req); });
+
+    // Phase 1: give the primary the hedge delay to answer (or fail fast)
+    state->cv.wait_for(lock, delay, [&]() {
+        return state->finished || state->outstanding == 0;
+    });
+
+    if (!state->finished) {
+        // Slow or already failed — duplicate onto a second connection
+        state->outstanding++;
+        if (trace::enabled()) {
+            uint64_t now = trace::now_us();
+            trace::emit("hedge", now, now); // marks where the duplicate went out
+        }
+        spawn_background([fire, req]() { fire(req); });
+    }
+
+    // Phase 2: first usable response wins; otherwise the last failure lands
+    state->cv.wait(lock, [&]() {
+        return state->finished || state->outstanding == 0;
+    });
+    return std::move(state->resp);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Disk cache front-end (RFC 7234)
+//   Fresh hits are served straight from disk; stale entries with validators
+//   become conditional requests whose 304 resolves locally; cacheable 200s
+//   are stored on the way out. Everything else falls through to the network.
+// ─────────────────────────────────────────────────────────────────────────────
+Response HTTPClient::Impl::execute_request(const Request& req) {
+    if (!disk_cache_ || req.method != "GET") {
+        return execute_network(req);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string key = req.url.to_string();
+    auto cached = disk_cache_->lookup(key);
+
+    if (cached && cached->fresh) {
+        Response resp = std::move(cached->response);
+        resp.from_cache = true;
+        resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        if (req.body_sink && !resp.body.empty()) {
+            req.body_sink(resp.body.data(), resp.body.size());
+            resp.body.clear();
+            resp.body.shrink_to_fit();
+        }
+        stats_.record_request(resp.elapsed_time, resp.bytes_received, req.url.host);
+        return resp;
+    }
+
+    if (cached) {
+        // Stale entry with validators: revalidate instead of refetching
+        Request cond = req;
+        if (!cached->etag.empty()) {
+            cond.headers.set("If-None-Match", cached->etag);
+        }
+        if (!cached->last_modified.empty()) {
+            cond.headers.set("If-Modified-Since", cached->last_modified);
+        }
+
+        Response resp = execute_network(cond);
+        if (resp.status_code == 304) {
+            // Not modified: restamp the entry and answer from disk
+            disk_cache_->refresh(key, resp);
+            Response out = std::move(cached->response);
+            out.from_cache = true;
+            out.elapsed_time = resp.elapsed_time;
+            if (req.body_sink && !out.body.empty()) {
+                req.body_sink(out.body.data(), out.body.size());
+                out.body.clear();
+                out.body.shrink_to_fit();
+            }
+            return out;
         }
+        if (resp.status_code == 200 && !req.body_sink) {
+            disk_cache_->store(key, resp);
+        }
+        return resp;
+    }
+
+    Response resp = execute_network(req);
+    // Streamed bodies never pass through here, so there is nothing to store
+    if (resp.status_code == 200 && !req.body_sink) {
+        disk_cache_->store(key, resp);
     }
-    
-    Response resp;
-    resp.status_code = 0;
-    stats_.record_error("max_retries_exceeded");
     return resp;
 }
 
-Response HTTPClient::Impl::execute_request(const Request& req) {
+Response HTTPClient::Impl::execute_network(const Request& req) {
     auto start = std::chrono::steady_clock::now();
-    
-    // Apply rate limiting
-    rate_limiter_->acquire();
+
+    // Apply rate limiting: the global cap first, then the per-origin one
+    {
+        trace::Span span("queue");
+        rate_limiter_->acquire();
+        host_rate_limiter_.acquire(req.url.host);
+    }
     
     bool use_tls = (req.url.scheme == "https");
-    
+
+    // ── HTTP/3 first when asked (-3) or learned from Alt-Svc ───────────────
+    if (enable_http3_ && use_tls &&
+        (req.prefer_http3 || host_advertises_h3(req.url.host))) {
+        if (auto h3_resp = try_http3(req)) {
+            h3_resp->elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+            stats_.record_request(h3_resp->elapsed_time, h3_resp->bytes_received, req.url.host);
+            stats_.record_protocol("h3");
+            follow_redirect_if_needed(req, *h3_resp);
+            return *h3_resp;
+        }
+        // QUIC unavailable or the handshake failed — TCP stack below
+    }
+
     auto conn = pool_.acquire(req.url.host, req.url.port, use_tls);
     if (!conn) {
         // ── NEW connection ─────────────────────────────────────────────────
@@ -573,6 +1416,9 @@ Response HTTPClient::Impl::execute_request(const Request& req) {
         auto dns_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::steady_clock::now() - dns_start);
         stats_.record_dns_lookup(dns_elapsed, false);
+        if (trace::enabled()) {
+            trace::emit("dns", steady_us(dns_start), trace::now_us());
+        }
         
         // ── Step 2: TCP connect (timed separately, starts after DNS done) ──
         auto tcp_start = std::chrono::steady_clock::now();
@@ -608,6 +1454,9 @@ Response HTTPClient::Impl::execute_request(const Request& req) {
         auto tcp_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::steady_clock::now() - tcp_start);
         stats_.record_tcp_handshake(tcp_elapsed);
+        if (trace::enabled()) {
+            trace::emit("connect", steady_us(tcp_start), trace::now_us());
+        }
         
         if (fd < 0) {
             Response resp;
@@ -622,7 +1471,13 @@ Response HTTPClient::Impl::execute_request(const Request& req) {
         conn->in_use = true;
         
         if (use_tls) {
+            trace::Span tls_span("tls"); // covers the h2 init too
             conn->tls = std::make_unique<TLSConnection>(fd, req.url.host);
+#ifdef HAVE_NGHTTP2
+            if (enable_http2_ && req.prefer_http2) {
+                conn->tls->enable_alpn_http2();
+            }
+#endif
             if (!conn->tls->handshake()) {
                 ::close(fd);
                 Response resp;
@@ -632,8 +1487,21 @@ Response HTTPClient::Impl::execute_request(const Request& req) {
                 stats_.record_error("tls_handshake_failed");
                 return resp;
             }
+            if (conn->tls->negotiated_http2()) {
+                // ALPN committed us to h2 — HTTP/1.1 is no longer valid here
+                conn->h2 = std::make_unique<HTTP2Session>(conn->tls.get(), req.url.host);
+                if (!conn->h2->init()) {
+                    ::close(fd);
+                    Response resp;
+                    resp.status_code = 0;
+                    resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start);
+                    stats_.record_error("http2_init_failed");
+                    return resp;
+                }
+            }
         }
-        
+
         stats_.record_connection(false); // Created++
     } else {
         // ── REUSED connection ──────────────────────────────────────────────
@@ -642,18 +1510,56 @@ Response HTTPClient::Impl::execute_request(const Request& req) {
         stats_.record_tcp_handshake(std::chrono::milliseconds(0));       // already established
         stats_.record_connection(true); // Reused++
     }
-    
-    // Build and send request
+
+    // ── HTTP/2 path: the request rides the multiplexed session ─────────────
+    if (conn->h2 && conn->h2->is_alive()) {
+        Response resp = execute_http2(req, *conn);
+        resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        if (conn->h2->is_alive()) {
+            pool_.release(req.url.host, req.url.port, conn);
+        } else if (conn->socket_fd >= 0) {
+            ::close(conn->socket_fd);
+        }
+
+        stats_.record_request(resp.elapsed_time, resp.bytes_received, req.url.host);
+        stats_.record_protocol("h2");
+        note_alt_svc(resp, req.url.host);
+        follow_redirect_if_needed(req, resp);
+        return resp;
+    }
+
+    // Build and send request. Small in-memory bodies ride in the same write
+    // as the headers — one sendmsg on plain TCP, one appended buffer through
+    // TLS — so the two never split into separate syscalls or TCP segments.
     std::string request_str = build_request(req);
-    
-    ssize_t sent;
+
+    static constexpr size_t MAX_INLINE_BODY = 65536;
+    bool body_inline = false;
+
+    uint64_t send_start_us = trace::enabled() ? trace::now_us() : 0;
+    bool send_ok;
     if (conn->tls) {
-        sent = conn->tls->send(request_str.data(), request_str.size());
+        if (!req.body.empty() && req.body_file.empty() &&
+            req.body.size() <= MAX_INLINE_BODY) {
+            request_str.append(reinterpret_cast<const char*>(req.body.data()),
+                               req.body.size());
+            body_inline = true;
+        }
+        send_ok = conn->tls->send(request_str.data(), request_str.size()) >= 0;
+    } else if (!req.body.empty() && req.body_file.empty()) {
+        send_ok = send_all_vectored(
+            conn->socket_fd,
+            reinterpret_cast<const uint8_t*>(request_str.data()),
+            request_str.size(), req.body.data(), req.body.size());
+        body_inline = true;
     } else {
-        sent = ::send(conn->socket_fd, request_str.data(), request_str.size(), MSG_NOSIGNAL);
+        send_ok = ::send(conn->socket_fd, request_str.data(),
+                         request_str.size(), MSG_NOSIGNAL) >= 0;
     }
-    
-    if (sent < 0) {
+
+    if (!send_ok) {
         ::close(conn->socket_fd);
         Response resp;
         resp.status_code = 0;
@@ -663,44 +1569,555 @@ Response HTTPClient::Impl::execute_request(const Request& req) {
         return resp;
     }
     
-    // Send body if present
-    if (!req.body.empty()) {
+    // Send body if present — files stream with constant memory
+    if (!req.body_file.empty()) {
+        if (!send_body_file(conn->socket_fd, conn->tls.get(), req.body_file)) {
+            ::close(conn->socket_fd);
+            Response resp;
+            resp.status_code = 0;
+            resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+            stats_.record_error("body_upload_failed");
+            return resp;
+        }
+    } else if (!req.body.empty() && !body_inline) {
         if (conn->tls) {
             conn->tls->send(req.body.data(), req.body.size());
         } else {
             ::send(conn->socket_fd, req.body.data(), req.body.size(), MSG_NOSIGNAL);
         }
     }
-    
-    // Read response
-    auto response_data = read_response(conn->socket_fd, conn->tls.get(), req.timeout, req.method);
-    
-    Response resp = parse_response(response_data, req.enable_compression);
+    if (send_start_us) {
+        trace::emit("send", send_start_us, trace::now_us());
+    }
+
+    // Read response — parsed incrementally as the bytes arrive
+    const BodySink* sink = req.body_sink ? &req.body_sink : nullptr;
+    Response resp = read_response(conn->socket_fd, conn->tls.get(), req.timeout,
+                                  req.method, req.enable_compression, sink);
     resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now() - start);
 
     // Return connection to pool
     pool_.release(req.url.host, req.url.port, conn);
-    
+
     // Record statistics
-    stats_.record_request(resp.elapsed_time, resp.bytes_received);
-    
+    stats_.record_request(resp.elapsed_time, resp.bytes_received, req.url.host);
+    stats_.record_protocol("http/1.1");
+    note_alt_svc(resp, req.url.host);
+
     // Handle redirects
-    if (req.follow_redirects && resp.status_code >= 300 && resp.status_code < 400) {
-        auto it = resp.headers.find("Location");
-        if (it != resp.headers.end() && req.max_redirects > 0) {
-            auto new_url = URL::parse(it->second);
+    follow_redirect_if_needed(req, resp);
+
+    return resp;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Epoll batch engine
+//   Drives all in-flight batch requests as non-blocking state machines on a
+//   single reactor thread (the caller's), instead of one std::async thread
+//   per request. Scales to thousands of concurrent requests without
+//   context-switch storms or 5 ms sleep-poll quanta.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+void set_socket_nonblocking(int fd, bool nonblocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (nonblocking) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    else             fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+}
+
+} // anonymous namespace
+
+class HTTPClient::Impl::BatchEngine {
+public:
+    BatchEngine(HTTPClient::Impl& impl,
+                     const std::vector<Request>& requests,
+                     std::vector<Response>& responses,
+                     int max_parallel)
+        : impl_(impl), requests_(requests), responses_(responses),
+          max_parallel_(std::max(1, max_parallel)) {
+    }
+
+    void run();
+
+private:
+    enum class State {
+        Idle,          // slot free
+        Backoff,       // waiting (rate limit or retry delay)
+        Connecting,    // non-blocking connect in flight
+        TlsHandshake,  // stepping the TLS handshake
+        Sending,       // flushing serialized request
+        Receiving,     // accumulating response bytes
+    };
+
+    struct Task {
+        State state = State::Idle;
+        size_t req_index = 0;
+        Request req;
+        std::shared_ptr<PooledConnection> conn;
+        bool registered = false;    // fd currently in the epoll set
+        uint32_t events = 0;        // events currently requested
+        std::string out;            // serialized request line + headers + body
+        size_t out_off = 0;
+        HTTP1Parser parser;         // consumes response bytes as they arrive
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point last_activity;
+        std::chrono::steady_clock::time_point backoff_until;
+        int attempts = 0;
+        int redirect_count = 0;
+    };
+
+    HTTPClient::Impl& impl_;
+    const std::vector<Request>& requests_;
+    std::vector<Response>& responses_;
+    int max_parallel_;
+
+    int epoll_fd_ = -1;
+    std::vector<Task> tasks_;
+    size_t next_request_ = 0;
+    size_t completed_ = 0;
+
+    void assign_next(Task& t);
+    void begin_attempt(Task& t);
+    void start_connect(Task& t);
+    void drive_handshake(Task& t);
+    void drive_send(Task& t);
+    void drive_recv(Task& t, bool peer_closed);
+    void finish(Task& t, Response resp, bool reuse_conn);
+    void fail(Task& t, const char* error_type);
+    void want(Task& t, uint32_t events);
+    void drop_fd(Task& t, bool close_it);
+};
+
+void HTTPClient::Impl::BatchEngine::want(Task& t, uint32_t events) {
+    if (!t.conn || t.conn->socket_fd < 0) return;
+
+    struct epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = static_cast<uint64_t>(&t - tasks_.data());
+
+    if (!t.registered) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, t.conn->socket_fd, &ev);
+        t.registered = true;
+    } else if (t.events != events) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, t.conn->socket_fd, &ev);
+    }
+    t.events = events;
+}
+
+void HTTPClient::Impl::BatchEngine::drop_fd(Task& t, bool close_it) {
+    if (t.conn && t.conn->socket_fd >= 0) {
+        if (t.registered) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, t.conn->socket_fd, nullptr);
+        }
+        if (close_it) {
+            ::close(t.conn->socket_fd);
+            t.conn->socket_fd = -1;
+        }
+    }
+    t.registered = false;
+    t.events = 0;
+}
+
+void HTTPClient::Impl::BatchEngine::assign_next(Task& t) {
+    if (next_request_ >= requests_.size()) {
+        t.state = State::Idle;
+        return;
+    }
+
+    t.req_index = next_request_++;
+    t.req = requests_[t.req_index];
+    t.attempts = 0;
+    t.redirect_count = 0;
+    t.start = std::chrono::steady_clock::now();
+    begin_attempt(t);
+}
+
+void HTTPClient::Impl::BatchEngine::begin_attempt(Task& t) {
+    t.conn.reset();
+    t.registered = false;
+    t.events = 0;
+    t.out.clear();
+    t.out_off = 0;
+    t.parser.reset();
+    t.parser.set_head_request(t.req.method == "HEAD");
+    t.last_activity = std::chrono::steady_clock::now();
+    t.attempts++;
+
+    // Rate limiting without blocking the reactor (global, then per-origin)
+    if (!impl_.rate_limiter_->try_acquire() ||
+        !impl_.host_rate_limiter_.try_acquire(t.req.url.host)) {
+        t.state = State::Backoff;
+        t.backoff_until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+        t.attempts--; // this wasn't a real attempt yet
+        return;
+    }
+
+    bool use_tls = (t.req.url.scheme == "https");
+
+    // Reuse a pooled connection when one is idle
+    auto conn = impl_.pool_.acquire(t.req.url.host, t.req.url.port, use_tls);
+    if (conn && conn->h2) {
+        // The engine only speaks HTTP/1.1 — put the h2 session back
+        impl_.pool_.release(t.req.url.host, t.req.url.port, conn);
+        conn.reset();
+    }
+    if (conn) {
+        impl_.stats_.record_dns_lookup(std::chrono::milliseconds(0), true);
+        impl_.stats_.record_tcp_handshake(std::chrono::milliseconds(0));
+        impl_.stats_.record_connection(true);
+
+        t.conn = std::move(conn);
+        set_socket_nonblocking(t.conn->socket_fd, true);
+        t.out = impl_.build_request(t.req);
+        if (!t.req.body.empty()) {
+            t.out.append(reinterpret_cast<const char*>(t.req.body.data()), t.req.body.size());
+        }
+        t.state = State::Sending;
+        want(t, EPOLLOUT);
+        return;
+    }
+
+    start_connect(t);
+}
+
+void HTTPClient::Impl::BatchEngine::start_connect(Task& t) {
+    // DNS is resolved synchronously (cached when the DNS cache is enabled);
+    // the connect itself is non-blocking and epoll-driven.
+    std::vector<sockaddr_storage> addrs;
+    auto dns_start = std::chrono::steady_clock::now();
+
+    if (impl_.dns_cache_) {
+        addrs = impl_.dns_cache_->resolve(t.req.url.host, t.req.url.port);
+    } else {
+        struct addrinfo hints{}, *res = nullptr;
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(t.req.url.host.c_str(),
+                        std::to_string(t.req.url.port).c_str(),
+                        &hints, &res) == 0 && res) {
+            for (struct addrinfo* ai = res; ai != nullptr; ai = ai->ai_next) {
+                sockaddr_storage addr{};
+                std::memcpy(&addr, ai->ai_addr, ai->ai_addrlen);
+                addrs.push_back(addr);
+            }
+            freeaddrinfo(res);
+        }
+    }
+
+    auto dns_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - dns_start);
+    impl_.stats_.record_dns_lookup(dns_elapsed, impl_.dns_cache_ != nullptr);
+
+    for (const auto& addr : addrs) {
+        int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) continue;
+
+        int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &flag, sizeof(flag));
+
+        socklen_t len = (addr.ss_family == AF_INET) ? sizeof(sockaddr_in) : sizeof(sockaddr_in6);
+        int ret = ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), len);
+        if (ret == 0 || errno == EINPROGRESS) {
+            t.conn = std::make_shared<PooledConnection>();
+            t.conn->socket_fd = fd;
+            t.conn->in_use = true;
+            t.state = State::Connecting;
+            want(t, EPOLLOUT);
+            return;
+        }
+        ::close(fd);
+    }
+
+    fail(t, "connection_failed");
+}
+
+void HTTPClient::Impl::BatchEngine::drive_handshake(Task& t) {
+    switch (t.conn->tls->handshake_step()) {
+        case TLSHandshakeStatus::Done:
+            impl_.stats_.record_connection(false);
+            t.out = impl_.build_request(t.req);
+            if (!t.req.body.empty()) {
+                t.out.append(reinterpret_cast<const char*>(t.req.body.data()), t.req.body.size());
+            }
+            t.state = State::Sending;
+            want(t, EPOLLOUT);
+            break;
+        case TLSHandshakeStatus::WantRead:
+            want(t, EPOLLIN);
+            break;
+        case TLSHandshakeStatus::WantWrite:
+            want(t, EPOLLOUT);
+            break;
+        case TLSHandshakeStatus::Error:
+            fail(t, "tls_handshake_failed");
+            break;
+    }
+}
+
+void HTTPClient::Impl::BatchEngine::drive_send(Task& t) {
+    while (t.out_off < t.out.size()) {
+        ssize_t sent;
+        if (t.conn->tls) {
+            sent = t.conn->tls->send_nonblocking(t.out.data() + t.out_off,
+                                                 t.out.size() - t.out_off);
+            if (sent == 0) { want(t, EPOLLOUT); return; } // would block
+        } else {
+            sent = ::send(t.conn->socket_fd, t.out.data() + t.out_off,
+                          t.out.size() - t.out_off, MSG_NOSIGNAL);
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                want(t, EPOLLOUT);
+                return;
+            }
+        }
+        if (sent < 0) {
+            fail(t, "send_failed");
+            return;
+        }
+        t.out_off += sent;
+        t.last_activity = std::chrono::steady_clock::now();
+    }
+
+    t.state = State::Receiving;
+    want(t, EPOLLIN);
+}
+
+void HTTPClient::Impl::BatchEngine::drive_recv(Task& t, bool peer_closed) {
+    uint8_t buffer[65536];
+
+    while (true) {
+        ssize_t n;
+        if (t.conn->tls) {
+            n = t.conn->tls->recv(buffer, sizeof(buffer));
+            if (n == 0) break;       // would block (TLS WANT_READ)
+            if (n < 0) { peer_closed = true; break; } // close_notify or error
+        } else {
+            n = ::recv(t.conn->socket_fd, buffer, sizeof(buffer), 0);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                peer_closed = true;
+                break;
+            }
+            if (n == 0) { peer_closed = true; break; }
+        }
+
+        g_downloaded.fetch_add(n);
+        t.last_activity = std::chrono::steady_clock::now();
+
+        auto st = t.parser.feed(buffer, static_cast<size_t>(n));
+        if (st == HTTP1Parser::Status::Complete) {
+            Response resp = t.parser.take_response();
+            impl_.finalize_body(resp, t.req.enable_compression);
+            finish(t, std::move(resp), true);
+            return;
+        }
+        if (st == HTTP1Parser::Status::Error) {
+            fail(t, "malformed_response");
+            return;
+        }
+    }
+
+    if (peer_closed) {
+        if (t.parser.finish_eof() == HTTP1Parser::Status::Complete) {
+            // Unknown length: close marks the end of the body
+            Response resp = t.parser.take_response();
+            impl_.finalize_body(resp, t.req.enable_compression);
+            finish(t, std::move(resp), false);
+        } else {
+            fail(t, t.parser.bytes_fed() == 0 ? "connection_closed" : "truncated_response");
+        }
+        return;
+    }
+
+    want(t, EPOLLIN);
+}
+
+void HTTPClient::Impl::BatchEngine::finish(Task& t, Response resp, bool reuse_conn) {
+    resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t.start);
+
+    drop_fd(t, !reuse_conn);
+    if (reuse_conn && t.conn && t.conn->socket_fd >= 0) {
+        set_socket_nonblocking(t.conn->socket_fd, false); // pool expects blocking
+        impl_.pool_.release(t.req.url.host, t.req.url.port, t.conn);
+    }
+    t.conn.reset();
+
+    // Redirect handling mirrors execute_request
+    if (t.req.follow_redirects && resp.status_code >= 300 && resp.status_code < 400) {
+        auto location = resp.headers.get("Location");
+        if (location && t.req.max_redirects > 0) {
+            auto new_url = URLView::parse(*location);
             if (new_url) {
-                Request new_req = req;
-                new_req.url = *new_url;
-                new_req.max_redirects = req.max_redirects - 1;
-                resp = execute_request(new_req);
-                resp.redirect_count++;
+                t.req.url = new_url->to_url();
+                t.req.max_redirects--;
+                t.redirect_count++;
+                t.attempts = 0;
+                begin_attempt(t);
+                return;
             }
         }
     }
-    
-    return resp;
+
+    // Retry on 5xx, mirroring execute_with_retry
+    if (resp.status_code >= 500 && t.attempts < t.req.max_retries + 1) {
+        auto delay = t.req.retry_delay;
+        if (t.req.exponential_backoff) {
+            delay *= (1 << (t.attempts - 1));
+        }
+        impl_.stats_.record_error("retry");
+        t.state = State::Backoff;
+        t.backoff_until = std::chrono::steady_clock::now() + delay;
+        return;
+    }
+
+    resp.redirect_count = t.redirect_count;
+    impl_.stats_.record_request(resp.elapsed_time, resp.bytes_received, t.req.url.host);
+    impl_.stats_.record_protocol("http/1.1");
+    impl_.note_alt_svc(resp, t.req.url.host);
+
+    // Streaming sinks still get the body, just in one shot: the batch engine
+    // buffers per-request to keep the state machines simple
+    if (t.req.body_sink && !resp.body.empty()) {
+        t.req.body_sink(resp.body.data(), resp.body.size());
+        resp.bytes_received = resp.body.size();
+        resp.body.clear();
+        resp.body.shrink_to_fit();
+    }
+
+    responses_[t.req_index] = std::move(resp);
+    completed_++;
+    assign_next(t);
+}
+
+void HTTPClient::Impl::BatchEngine::fail(Task& t, const char* error_type) {
+    drop_fd(t, true);
+    t.conn.reset();
+    impl_.stats_.record_error(error_type);
+
+    if (t.attempts < t.req.max_retries + 1) {
+        auto delay = t.req.retry_delay;
+        if (t.req.exponential_backoff) {
+            delay *= (1 << (t.attempts - 1));
+        }
+        impl_.stats_.record_error("retry");
+        t.state = State::Backoff;
+        t.backoff_until = std::chrono::steady_clock::now() + delay;
+        return;
+    }
+
+    Response resp;
+    resp.status_code = 0;
+    resp.elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t.start);
+
+    responses_[t.req_index] = std::move(resp);
+    completed_++;
+    assign_next(t);
+}
+
+void HTTPClient::Impl::BatchEngine::run() {
+    if (requests_.empty()) {
+        return;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        // Degraded mode: run everything sequentially
+        for (size_t i = 0; i < requests_.size(); ++i) {
+            responses_[i] = impl_.execute_with_retry(requests_[i]);
+        }
+        return;
+    }
+
+    size_t slots = std::min(static_cast<size_t>(max_parallel_), requests_.size());
+    tasks_.resize(slots);
+    for (auto& t : tasks_) {
+        assign_next(t);
+    }
+
+    struct epoll_event events[256];
+
+    while (completed_ < requests_.size()) {
+        int n = epoll_wait(epoll_fd_, events, 256, 50);
+
+        for (int i = 0; i < n; ++i) {
+            size_t idx = static_cast<size_t>(events[i].data.u64);
+            if (idx >= tasks_.size()) continue;
+            Task& t = tasks_[idx];
+            bool peer_closed = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+
+            switch (t.state) {
+                case State::Connecting: {
+                    int err = 0;
+                    socklen_t el = sizeof(err);
+                    getsockopt(t.conn->socket_fd, SOL_SOCKET, SO_ERROR, &err, &el);
+                    if (err != 0 || peer_closed) {
+                        fail(t, "connection_failed");
+                        break;
+                    }
+                    if (t.req.url.scheme == "https") {
+                        t.conn->tls = std::make_unique<TLSConnection>(
+                            t.conn->socket_fd, t.req.url.host);
+                        t.state = State::TlsHandshake;
+                        drive_handshake(t);
+                    } else {
+                        impl_.stats_.record_connection(false);
+                        t.out = impl_.build_request(t.req);
+                        if (!t.req.body.empty()) {
+                            t.out.append(reinterpret_cast<const char*>(t.req.body.data()),
+                                         t.req.body.size());
+                        }
+                        t.state = State::Sending;
+                        drive_send(t);
+                    }
+                    break;
+                }
+                case State::TlsHandshake:
+                    if (peer_closed) { fail(t, "tls_handshake_failed"); break; }
+                    drive_handshake(t);
+                    break;
+                case State::Sending:
+                    if (peer_closed) { fail(t, "send_failed"); break; }
+                    drive_send(t);
+                    break;
+                case State::Receiving:
+                    drive_recv(t, peer_closed);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Timers: retry backoff, rate-limit waits, and inactivity timeouts
+        auto now = std::chrono::steady_clock::now();
+        for (auto& t : tasks_) {
+            if (t.state == State::Backoff) {
+                if (now >= t.backoff_until) {
+                    begin_attempt(t);
+                }
+            } else if (t.state != State::Idle) {
+                auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - t.last_activity);
+                if (idle >= t.req.timeout) {
+                    if (t.state == State::Receiving &&
+                        t.parser.finish_eof() == HTTP1Parser::Status::Complete) {
+                        // Unknown-length body that simply stopped: treat as done
+                        Response resp = t.parser.take_response();
+                        impl_.finalize_body(resp, t.req.enable_compression);
+                        finish(t, std::move(resp), false);
+                    } else {
+                        fail(t, "timeout");
+                    }
+                }
+            }
+        }
+    }
+
+    ::close(epoll_fd_);
+    epoll_fd_ = -1;
 }
 
 // Public API implementation
@@ -739,12 +2156,15 @@ Response HTTPClient::post(const std::string& url, const std::vector<uint8_t>& da
     req.url = *parsed_url;
     req.body = data;
     req.timeout = impl_->default_timeout_;
-    req.headers["Content-Type"] = "application/octet-stream";
+    req.headers.set("Content-Type", "application/octet-stream");
     
     return impl_->execute_request(req);
 }
 
 Response HTTPClient::request(const Request& req) {
+    if (req.enable_hedging) {
+        return impl_->execute_hedged(req);
+    }
     if (req.max_retries > 0) {
         return impl_->execute_with_retry(req);
     }
@@ -753,33 +2173,85 @@ Response HTTPClient::request(const Request& req) {
 
 std::vector<Response> HTTPClient::batch_request(const std::vector<Request>& requests, int max_parallel) {
     std::vector<Response> responses(requests.size());
-    std::vector<std::future<Response>> futures;
-    
-    size_t idx = 0;
-    while (idx < requests.size()) {
-        // Launch parallel requests
-        while (futures.size() < static_cast<size_t>(max_parallel) && idx < requests.size()) {
-            size_t current_idx = idx;
-            futures.push_back(std::async(std::launch::async, [this, &requests, current_idx]() {
-                return this->request(requests[current_idx]);
-            }));
-            idx++;
+
+    std::vector<size_t> h1_indices;
+    h1_indices.reserve(requests.size());
+
+    if (impl_->enable_http2_) {
+        // Group same-host HTTPS requests so each group multiplexes over a
+        // single HTTP/2 connection instead of opening -P parallel sockets
+        std::map<std::pair<std::string, int>, std::vector<size_t>> groups;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            const auto& req = requests[i];
+            if (req.url.scheme == "https" && req.prefer_http2) {
+                groups[{req.url.host, req.url.port}].push_back(i);
+            } else {
+                h1_indices.push_back(i);
+            }
         }
-        
-        // Wait for first completed
-        if (!futures.empty()) {
-            size_t completed_idx = responses.size() - futures.size();
-            responses[completed_idx] = futures.front().get();
-            futures.erase(futures.begin());
+
+        for (auto& [key, indices] : groups) {
+            if (!impl_->try_http2_batch(requests, indices, responses)) {
+                // Host doesn't speak h2 (or the session died) — HTTP/1.1 path
+                h1_indices.insert(h1_indices.end(), indices.begin(), indices.end());
+            }
+        }
+    } else {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            h1_indices.push_back(i);
         }
     }
-    
-    // Wait for remaining
-    for (auto& future : futures) {
-        size_t completed_idx = responses.size() - futures.size();
-        responses[completed_idx] = future.get();
+
+    if (impl_->enable_pipelining_ && h1_indices.size() > 1) {
+        // Same-host idempotent runs go back-to-back on one connection;
+        // anything the pipeline can't take — or a failed attempt — stays
+        // with the epoll engine
+        std::map<std::pair<std::string, int>, std::vector<size_t>> pipeline_groups;
+        std::vector<size_t> rest;
+        for (size_t idx : h1_indices) {
+            const auto& req = requests[idx];
+            bool idempotent = req.method == "GET" || req.method == "HEAD";
+            if (idempotent && !req.body_sink && req.body.empty() &&
+                req.body_file.empty()) {
+                pipeline_groups[{req.url.host, req.url.port}].push_back(idx);
+            } else {
+                rest.push_back(idx);
+            }
+        }
+
+        h1_indices = std::move(rest);
+        for (auto& [key, indices] : pipeline_groups) {
+            std::vector<size_t> unanswered;
+            if (indices.size() < 2 ||
+                !impl_->try_pipeline_batch(requests, indices, responses,
+                                           unanswered)) {
+                h1_indices.insert(h1_indices.end(), indices.begin(), indices.end());
+            } else {
+                // Keep-alive ran out mid-run — the leftovers execute normally
+                h1_indices.insert(h1_indices.end(), unanswered.begin(),
+                                  unanswered.end());
+            }
+        }
     }
-    
+
+    if (!h1_indices.empty()) {
+        // Everything else is multiplexed over one epoll loop instead of a
+        // thread per request — see Impl::BatchEngine above
+        std::vector<Request> h1_requests;
+        h1_requests.reserve(h1_indices.size());
+        for (size_t idx : h1_indices) {
+            h1_requests.push_back(requests[idx]);
+        }
+
+        std::vector<Response> h1_responses(h1_requests.size());
+        Impl::BatchEngine engine(*impl_, h1_requests, h1_responses, max_parallel);
+        engine.run();
+
+        for (size_t i = 0; i < h1_indices.size(); ++i) {
+            responses[h1_indices[i]] = std::move(h1_responses[i]);
+        }
+    }
+
     return responses;
 }
 
@@ -792,13 +2264,21 @@ void HTTPClient::set_user_agent(const std::string& ua) {
 }
 
 void HTTPClient::set_max_connections(int max) {
-    // Update pool size (implementation in ConnectionPool would need this)
+    impl_->pool_.set_max_connections(max);
 }
 
 void HTTPClient::enable_http2(bool enable) {
     impl_->enable_http2_ = enable;
 }
 
+void HTTPClient::enable_http3(bool enable) {
+    impl_->enable_http3_ = enable;
+}
+
+void HTTPClient::enable_pipelining(bool enable) {
+    impl_->enable_pipelining_ = enable;
+}
+
 void HTTPClient::enable_compression(bool enable) {
     impl_->enable_compression_ = enable;
 }
@@ -807,6 +2287,18 @@ void HTTPClient::set_rate_limit(double requests_per_second, size_t burst) {
     impl_->rate_limiter_->set_rate(requests_per_second, burst);
 }
 
+void HTTPClient::set_per_host_rate_limit(double requests_per_second, size_t burst) {
+    impl_->host_rate_limiter_.set_rate(requests_per_second, burst);
+}
+
+void HTTPClient::enable_disk_cache(bool enable, const std::string& dir) {
+    if (enable) {
+        impl_->disk_cache_ = std::make_unique<DiskCache>(dir);
+    } else {
+        impl_->disk_cache_.reset();
+    }
+}
+
 void HTTPClient::enable_dns_cache(bool enable, std::chrono::seconds ttl) {
     if (enable) {
         impl_->dns_cache_ = std::make_unique<DNSCache>(ttl);
@@ -815,6 +2307,12 @@ void HTTPClient::enable_dns_cache(bool enable, std::chrono::seconds ttl) {
     }
 }
 
+void HTTPClient::preconnect(const std::string& host, int port, int n) {
+    if (n > 0) {
+        impl_->preconnect(host, port, n);
+    }
+}
+
 void HTTPClient::warmup_dns(const std::vector<std::string>& hosts) {
     if (impl_->dns_cache_) {
         for (const auto& host : hosts) {
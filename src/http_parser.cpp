@@ -0,0 +1,313 @@
+#include "http_parser.hpp"
+#include "simd_scan.hpp"
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+namespace crawl {
+
+namespace {
+
+// Case-insensitive header name comparison without allocating lowercase copies
+bool header_iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (::tolower((unsigned char)a[i]) != ::tolower((unsigned char)b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+HTTP1Parser::HTTP1Parser() {
+    line_.reserve(128);
+}
+
+void HTTP1Parser::reset() {
+    state_ = State::StatusLine;
+    resp_ = Response{};
+    line_.clear();
+    head_request_ = false;
+    headers_complete_ = false;
+    chunked_ = false;
+    has_content_length_ = false;
+    content_length_ = 0;
+    body_received_ = 0;
+    bytes_fed_ = 0;
+    last_consumed_ = 0;
+    chunk_remaining_ = 0;
+    trailer_line_len_ = 0;
+    headers_cb_ = nullptr;
+    body_handler_ = nullptr;
+}
+
+void HTTP1Parser::set_head_request(bool head) {
+    head_request_ = head;
+}
+
+void HTTP1Parser::set_headers_callback(std::function<void()> cb) {
+    headers_cb_ = std::move(cb);
+}
+
+void HTTP1Parser::set_body_handler(BodySink handler) {
+    body_handler_ = std::move(handler);
+}
+
+bool HTTP1Parser::deliver(const uint8_t* data, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    body_received_ += len;
+    if (body_handler_) {
+        return body_handler_(data, len);
+    }
+    resp_.body.insert(resp_.body.end(), data, data + len);
+    return true;
+}
+
+void HTTP1Parser::parse_status_line() {
+    // "HTTP/1.1 200 OK"
+    size_t pos = line_.find(' ');
+    if (pos == std::string::npos) {
+        state_ = State::Error;
+        return;
+    }
+    pos++;
+
+    int code = 0;
+    size_t code_start = pos;
+    while (pos < line_.size() && line_[pos] >= '0' && line_[pos] <= '9') {
+        code = code * 10 + (line_[pos++] - '0');
+    }
+    if (pos == code_start) {
+        state_ = State::Error;
+        return;
+    }
+    resp_.status_code = code;
+
+    if (pos < line_.size() && line_[pos] == ' ') {
+        pos++;
+    }
+    resp_.status_message = line_.substr(pos);
+}
+
+bool HTTP1Parser::parse_header_line() {
+    size_t colon = simd::find_byte(
+        reinterpret_cast<const uint8_t*>(line_.data()), line_.size(), ':');
+    if (colon == line_.size()) {
+        return true; // tolerate junk lines, like the old parser did
+    }
+
+    std::string_view name(line_.data(), colon);
+
+    size_t vs = colon + 1;
+    while (vs < line_.size() && (line_[vs] == ' ' || line_[vs] == '\t')) vs++;
+    std::string_view value(line_.data() + vs, line_.size() - vs);
+
+    // Framing headers are inspected here so the body machinery is ready the
+    // moment the blank line arrives
+    if (header_iequals(name, "content-length")) {
+        has_content_length_ = true;
+        content_length_ = 0;
+        for (char c : value) {
+            if (c >= '0' && c <= '9') content_length_ = content_length_ * 10 + (c - '0');
+            else break;
+        }
+    } else if (header_iequals(name, "transfer-encoding") &&
+               value.find("chunked") != std::string_view::npos) {
+        chunked_ = true;
+    }
+
+    resp_.headers.add(name, value); // bytes go straight into the arena
+    return true;
+}
+
+void HTTP1Parser::on_headers_end() {
+    headers_complete_ = true;
+    if (headers_cb_) {
+        headers_cb_();
+    }
+
+    // Messages defined to have no body
+    if (head_request_ || resp_.status_code == 204 || resp_.status_code == 304) {
+        state_ = State::Done;
+        return;
+    }
+
+    if (chunked_) {
+        state_ = State::ChunkSize;
+        chunk_remaining_ = 0;
+    } else if (has_content_length_) {
+        state_ = (content_length_ == 0) ? State::Done : State::FixedBody;
+    } else {
+        state_ = State::EofBody;
+    }
+}
+
+HTTP1Parser::Status HTTP1Parser::feed(const uint8_t* data, size_t len) {
+    bytes_fed_ += len;
+    size_t i = 0;
+
+    while (i < len && state_ != State::Done && state_ != State::Error) {
+        switch (state_) {
+            case State::StatusLine:
+            case State::Headers: {
+                // Scan only the new bytes for the line terminator
+                size_t nl = simd::find_byte(data + i, len - i, '\n');
+                if (nl == len - i) {
+                    line_.append(reinterpret_cast<const char*>(data + i), len - i);
+                    i = len;
+                    break;
+                }
+
+                line_.append(reinterpret_cast<const char*>(data + i), nl);
+                i += nl + 1;
+                if (!line_.empty() && line_.back() == '\r') {
+                    line_.pop_back();
+                }
+
+                if (state_ == State::StatusLine) {
+                    parse_status_line();
+                    if (state_ != State::Error) {
+                        state_ = State::Headers;
+                    }
+                } else if (line_.empty()) {
+                    on_headers_end();
+                } else {
+                    parse_header_line();
+                }
+                line_.clear();
+                break;
+            }
+
+            case State::FixedBody: {
+                size_t take = std::min(len - i, content_length_ - body_received_);
+                if (!deliver(data + i, take)) {
+                    state_ = State::Error;
+                    break;
+                }
+                i += take;
+                if (body_received_ >= content_length_) {
+                    state_ = State::Done;
+                }
+                break;
+            }
+
+            case State::EofBody:
+                if (!deliver(data + i, len - i)) {
+                    state_ = State::Error;
+                    break;
+                }
+                i = len;
+                break;
+
+            case State::ChunkSize: {
+                // Classify the whole hex digit run in one vectorized pass,
+                // then accumulate; separators fall through to the byte cases
+                size_t span = simd::hex_span(data + i, len - i);
+                if (span > 0) {
+                    for (size_t j = 0; j < span; ++j) {
+                        uint8_t h = data[i + j];
+                        int v = (h <= '9') ? h - '0' : (h | 0x20) - 'a' + 10;
+                        chunk_remaining_ = chunk_remaining_ * 16 + v;
+                    }
+                    i += span;
+                    break;
+                }
+
+                uint8_t c = data[i];
+                if (c == ';') {
+                    state_ = State::ChunkExt;
+                } else if (c == '\n') {
+                    // Size line done: zero size means last chunk
+                    state_ = (chunk_remaining_ == 0) ? State::Trailer : State::ChunkData;
+                    trailer_line_len_ = 0;
+                } else if (c != '\r') {
+                    state_ = State::Error; // malformed chunk size
+                    break;
+                }
+                i++;
+                break;
+            }
+
+            case State::ChunkExt:
+                if (data[i] == '\n') {
+                    state_ = (chunk_remaining_ == 0) ? State::Trailer : State::ChunkData;
+                    trailer_line_len_ = 0;
+                }
+                i++;
+                break;
+
+            case State::ChunkData: {
+                size_t take = std::min(chunk_remaining_, len - i);
+                if (!deliver(data + i, take)) {
+                    state_ = State::Error;
+                    break;
+                }
+                chunk_remaining_ -= take;
+                i += take;
+                if (chunk_remaining_ == 0) {
+                    state_ = State::ChunkDataCr;
+                }
+                break;
+            }
+
+            case State::ChunkDataCr:
+                if (data[i] == '\r') {
+                    state_ = State::ChunkDataLf;
+                    i++;
+                    break;
+                }
+                [[fallthrough]];
+            case State::ChunkDataLf:
+                if (data[i] != '\n') {
+                    state_ = State::Error;
+                    break;
+                }
+                state_ = State::ChunkSize;
+                chunk_remaining_ = 0;
+                i++;
+                break;
+
+            case State::Trailer:
+                // Consume optional trailer headers until the empty line
+                if (data[i] == '\n') {
+                    if (trailer_line_len_ == 0) {
+                        state_ = State::Done;
+                    }
+                    trailer_line_len_ = 0;
+                } else if (data[i] != '\r') {
+                    trailer_line_len_++;
+                }
+                i++;
+                break;
+
+            case State::Done:
+            case State::Error:
+                break;
+        }
+    }
+
+    last_consumed_ = i;
+
+    if (state_ == State::Error) return Status::Error;
+    if (state_ == State::Done)  return Status::Complete;
+    return Status::NeedMore;
+}
+
+HTTP1Parser::Status HTTP1Parser::finish_eof() {
+    if (state_ == State::Done) {
+        return Status::Complete;
+    }
+    if (state_ == State::EofBody) {
+        // Close marks the end of an unknown-length body
+        state_ = State::Done;
+        return Status::Complete;
+    }
+    state_ = State::Error;
+    return Status::Error;
+}
+
+} // namespace crawl
@@ -1,5 +1,7 @@
 #include "http_client.hpp"
+#include "async_writer.hpp"
 #include "stats.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -14,8 +16,10 @@
 #include <algorithm>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <cstdio>
-#include <map>
+#include <deque>
+#include <condition_variable>
 
 // Define our Color Palette
 #define RESET   "\033[0m"
@@ -156,134 +160,280 @@ static void progress_thread_loop() {
     fflush(stderr); // Ensure it's printed
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// Resume sidecar (<output>.crawlresume)
+//   Plain-text record of a parallel download's segment map: total length,
+//   chunk size, the validators the server sent, and one done-flag per chunk.
+//   Rewritten (atomically, via rename) every time a chunk completes; removed
+//   once the whole file is durable. --resume reads it back, checks the
+//   validators against a fresh HEAD, and re-requests only the missing chunks.
+// ─────────────────────────────────────────────────────────────────────────────
+struct ResumeState {
+    size_t content_length = 0;
+    size_t chunk_size = 0;
+    std::string etag = "-";          // "-" when the server sent none
+    std::string last_modified = "-";
+    std::vector<char> done;          // '1' per completed chunk
+};
+
+static std::string resume_path(const std::string& output_file) {
+    return output_file + ".crawlresume";
+}
+
+static bool load_resume_state(const std::string& path, ResumeState& st) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != "CRAWLRESUME 1") return false;
+
+    auto value_after = [](const std::string& l, const char* key) {
+        return l.substr(strlen(key) + 1); // "key value-with-spaces"
+    };
+    while (std::getline(in, line)) {
+        if (line.rfind("length ", 0) == 0) {
+            st.content_length = 0;
+            for (char c : value_after(line, "length"))
+                if (c >= '0' && c <= '9') st.content_length = st.content_length*10+(c-'0');
+        } else if (line.rfind("chunk ", 0) == 0) {
+            st.chunk_size = 0;
+            for (char c : value_after(line, "chunk"))
+                if (c >= '0' && c <= '9') st.chunk_size = st.chunk_size*10+(c-'0');
+        } else if (line.rfind("etag ", 0) == 0) {
+            st.etag = value_after(line, "etag");
+        } else if (line.rfind("last-modified ", 0) == 0) {
+            st.last_modified = value_after(line, "last-modified");
+        } else if (line.rfind("done ", 0) == 0) {
+            std::string flags = value_after(line, "done");
+            st.done.assign(flags.begin(), flags.end());
+        }
+    }
+    return st.content_length > 0 && st.chunk_size > 0 && !st.done.empty();
+}
+
+static void save_resume_state(const std::string& path, const ResumeState& st) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return; // losing the sidecar only costs a re-download
+        out << "CRAWLRESUME 1\n"
+            << "length " << st.content_length << "\n"
+            << "chunk " << st.chunk_size << "\n"
+            << "etag " << st.etag << "\n"
+            << "last-modified " << st.last_modified << "\n"
+            << "done " << std::string(st.done.begin(), st.done.end()) << "\n";
+    }
+    std::rename(tmp.c_str(), path.c_str());
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Parallel range download
-//   Splits file into `num_pipes` segments using HTTP Range requests.
+//   The file is cut into many small chunks pulled from a shared queue, so a
+//   fast connection keeps grabbing work while a throttled one plods through
+//   its current chunk — wall-clock tracks aggregate bandwidth instead of the
+//   slowest pipe. The output file is preallocated up front and each chunk
+//   pwrite()s its bytes at their final offset as they arrive — no in-memory
+//   reassembly, O(read buffer) memory per pipe.
 //   Falls back to single-threaded if server doesn't support Accept-Ranges.
 // ─────────────────────────────────────────────────────────────────────────────
-static std::vector<uint8_t> parallel_download(
+static bool parallel_download(
         const std::string& url_str,
+        const std::string& output_file,
         size_t content_length,
         int num_pipes,
         bool show_progress,
         HTTPClient& client,
         std::string method,
-        std::map<std::string,std::string> extra_headers,
+        HeaderMap extra_headers,
         int max_time,
-        bool no_compress) {
+        bool no_compress,
+        bool resume,
+        const std::string& etag,
+        const std::string& last_modified) {
 
     if (num_pipes < 2 || content_length == 0) {
-        return {}; // caller handles single-pipe
+        return false; // caller handles single-pipe
+    }
+
+    // Many small chunks, not num_pipes big ones: aim for ~8 chunks per pipe,
+    // clamped to [1MB, 32MB] so tiny files don't drown in request overhead
+    // and one straggling chunk never holds much of the file hostage
+    size_t chunk_size = content_length / ((size_t)num_pipes * 8);
+    const size_t MIN_CHUNK = 1 << 20, MAX_CHUNK = 32u << 20;
+    chunk_size = std::max(MIN_CHUNK, std::min(MAX_CHUNK, chunk_size));
+
+    // A valid sidecar overrides the computed chunk size — the layout must
+    // match the bytes already on disk even if -P changed between runs.
+    // Resume needs at least one validator: same length alone doesn't prove
+    // the remote file is the one we started downloading.
+    ResumeState state;
+    bool resuming = false;
+    if (resume) {
+        ResumeState prev;
+        std::string cur_etag = etag.empty() ? "-" : etag;
+        std::string cur_lm   = last_modified.empty() ? "-" : last_modified;
+        if (load_resume_state(resume_path(output_file), prev) &&
+            prev.content_length == content_length &&
+            prev.etag == cur_etag && prev.last_modified == cur_lm &&
+            !(prev.etag == "-" && prev.last_modified == "-")) {
+            state = std::move(prev);
+            chunk_size = state.chunk_size;
+            resuming = true;
+        } else {
+            fprintf(stderr, "Resume state missing, stale or unvalidated — "
+                            "restarting from byte zero\n");
+        }
+    }
+
+    struct Chunk {
+        size_t start;
+        size_t end; // inclusive
+    };
+    std::vector<Chunk> chunks;
+    for (size_t off = 0; off < content_length; off += chunk_size) {
+        chunks.push_back({off, std::min(off + chunk_size, content_length) - 1});
     }
 
-    // Split into equal chunks
-    size_t segment_size = content_length / num_pipes;
+    if (!resuming || state.done.size() != chunks.size()) {
+        state = ResumeState{};
+        state.content_length = content_length;
+        state.chunk_size = chunk_size;
+        state.etag = etag.empty() ? "-" : etag;
+        state.last_modified = last_modified.empty() ? "-" : last_modified;
+        state.done.assign(chunks.size(), '0');
+        resuming = false;
+    }
+
+    // Only the chunks not already on disk go into the work queue
+    std::vector<size_t> pending_chunks;
+    size_t resumed_bytes = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (state.done[i] == '1') {
+            resumed_bytes += chunks[i].end - chunks[i].start + 1;
+        } else {
+            pending_chunks.push_back(i);
+        }
+    }
+
+    // One async writer stage shared by all pipes: chunks go to disk on its
+    // writer thread while the pipes keep receiving. Preallocation reserves
+    // the full file so offset writes never race extending it. On resume the
+    // file is opened without truncation — completed chunks stay put.
+    AsyncFileWriter writer(output_file, content_length, !resuming);
+    if (!writer.valid()) {
+        std::cerr << "Error: Cannot open output file\n";
+        return false;
+    }
 
     if (show_progress) {
         g_total = content_length;
-        fprintf(stderr, "Parallel download: %d pipes\n", num_pipes);
+        g_downloaded = resumed_bytes;
+        fprintf(stderr, "Parallel download: %d pipes, %zu chunks%s\n",
+                num_pipes, pending_chunks.size(),
+                resuming ? " remaining (resumed)" : "");
     }
 
-    std::vector<std::vector<uint8_t>> parts(num_pipes);
-    std::mutex err_mtx;
-    bool any_failed = false;
+    // Record the segment map before the first byte moves, and after every
+    // chunk completes. A done-flag can run slightly ahead of durability
+    // (the chunk may still sit in the writer queue when the power fails);
+    // finish() fdatasyncs before the sidecar is removed, so only a hard
+    // kill inside that window costs a re-downloaded chunk.
+    std::mutex state_mutex;
+    save_resume_state(resume_path(output_file), state);
+    auto mark_chunk_done = [&](size_t idx) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        state.done[idx] = '1';
+        save_resume_state(resume_path(output_file), state);
+    };
+
+    // Shared work queue: pipes pull the next chunk as soon as they're free
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<bool> any_failed{false};
 
+    int num_workers = std::min((size_t)num_pipes, pending_chunks.size());
     std::vector<std::thread> threads;
-    threads.reserve(num_pipes);
+    threads.reserve(num_workers);
 
-    for (int i = 0; i < num_pipes; ++i) {
-        threads.emplace_back([&, i, segment_size]() {
+    for (int i = 0; i < num_workers; ++i) {
+        threads.emplace_back([&]() {
             HTTPClient pipe_client;
             auto parsed = URL::parse(url_str);
             if (!parsed) return;
 
-            Request req;
-            req.method  = method;
-            req.url     = *parsed;
-            req.headers = extra_headers;
-            req.timeout = std::chrono::seconds(max_time);
-            req.enable_compression = !no_compress;
-
-                                    // Set Range header
-
-                                    size_t start_byte = i * segment_size;
-
-                                    char range_hdr[64];
-
-                                    std::string range_debug_str; // For debug message - KEEP as it's part of the new range logic
-
-                                    if (i == num_pipes - 1) { // Last pipe
-
-                                        snprintf(range_hdr, sizeof(range_hdr), "bytes=%zu-", start_byte);
-
-                                        range_debug_str = std::to_string(start_byte) + "-";
-
-                                    } else {
-
-                                        size_t end_byte = (i + 1) * segment_size - 1;
-
-                                        snprintf(range_hdr, sizeof(range_hdr), "bytes=%zu-%zu", start_byte, end_byte);
-
-                                        range_debug_str = std::to_string(start_byte) + "-" + std::to_string(end_byte);
-
-                                    }
-
-                                    req.headers["Range"] = range_hdr;
-
-                        
-
-                                    Response resp;
-
-                                    int retries = 0;
-
-                                    const int MAX_RETRIES = 3;
-
-                                    do {
-
-                                        if (retries > 0) {
-
-                                            std::this_thread::sleep_for(std::chrono::seconds(1)); // Simple delay
-
-                                        }
-
-                                        resp = pipe_client.request(req);
-
-                                        retries++;
-
-                                    } while (resp.status_code != 206 && retries < MAX_RETRIES);
-
-                        
-
-                                    if (resp.status_code == 206) {
-
-                                        parts[i] = std::move(resp.body);
-
-                                        // g_downloaded.fetch_add(resp.bytes_received); // This was redundant
-
-                                    } else {
-
-                                        std::lock_guard<std::mutex> lk(err_mtx);
-
-                                        any_failed = true;
-
-                                    }
+            while (!any_failed.load(std::memory_order_relaxed)) {
+                size_t slot = next_chunk.fetch_add(1);
+                if (slot >= pending_chunks.size()) break;
+                size_t idx = pending_chunks[slot];
+                const Chunk& chunk = chunks[idx];
+
+                Request req;
+                req.method  = method;
+                req.url     = *parsed;
+                req.headers = extra_headers;
+                req.timeout = std::chrono::seconds(max_time);
+                req.enable_compression = !no_compress;
+
+                char range_hdr[64];
+                snprintf(range_hdr, sizeof(range_hdr), "bytes=%zu-%zu",
+                         chunk.start, chunk.end);
+                req.headers.set("Range", range_hdr);
+
+                // Queue the chunk at its final offset; the writer thread
+                // overlaps the disk I/O with this pipe's next recv. Writes
+                // are clamped to the requested range: a server that ignores
+                // Range answers 200 with the whole body, and letting it
+                // stream through would overwrite neighbouring chunks —
+                // including ones the resume sidecar already marks done.
+                // Over-delivery aborts the attempt instead.
+                size_t write_off = chunk.start;
+                req.body_sink = [&](const uint8_t* data, size_t len) {
+                    if (len > chunk.end + 1 - write_off) {
+                        return false; // body exceeds the requested range
+                    }
+                    if (!writer.write(write_off, data, len)) {
+                        return false;
+                    }
+                    write_off += len;
+                    return true;
+                };
+
+                Response resp;
+                int retries = 0;
+                const int MAX_RETRIES = 3;
+                do {
+                    if (retries > 0) {
+                        std::this_thread::sleep_for(std::chrono::seconds(1)); // Simple delay
+                    }
+                    // A retried chunk resumes from wherever the last attempt
+                    // died instead of re-downloading bytes already on disk
+                    if (write_off > chunk.start) {
+                        snprintf(range_hdr, sizeof(range_hdr), "bytes=%zu-%zu",
+                                 write_off, chunk.end);
+                        req.headers.set("Range", range_hdr);
+                    }
+                    resp = pipe_client.request(req);
+                    retries++;
+                } while ((resp.status_code != 206 || write_off <= chunk.end) &&
+                         retries < MAX_RETRIES);
+
+                if (resp.status_code != 206 || write_off <= chunk.end) {
+                    any_failed.store(true, std::memory_order_relaxed);
+                } else {
+                    mark_chunk_done(idx);
+                }
+            }
         });
     }
 
     for (auto& t : threads) t.join();
 
-    if (any_failed || show_progress) {
-        // check if we actually got parts
+    // Drain and fdatasync — on return every block is durable
+    if (!writer.finish() || any_failed.load()) {
+        // The sidecar stays behind: --resume picks up from here
+        return false;
     }
-
-    // Assemble in order
-    std::vector<uint8_t> result;
-    result.reserve(content_length);
-    for (int i = 0; i < num_pipes; ++i) {
-        result.insert(result.end(), parts[i].begin(), parts[i].end());
-    }
-
-    return result;
+    ::unlink(resume_path(output_file).c_str());
+    return true;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -325,6 +475,7 @@ void print_usage(const char* prog_name) {
     std::cout << "│  " << GREEN << "-X, --request <method>    " << PINK << "HTTP method (GET, POST, etc.)      " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-H, --header <header>     " << PINK << "Add custom header (repeatable)     " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-d, --data <data>         " << PINK << "HTTP POST data                     " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "-T, --upload-file <file>  " << PINK << "Stream request body from file      " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-o, --output <file>       " << PINK << "Write output to file               " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-i, --include             " << PINK << "Include headers in output          " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-v, --verbose             " << PINK << "Verbose output with timing         " << GREY << "│\n";
@@ -337,6 +488,7 @@ void print_usage(const char* prog_name) {
     std::cout << "│  " << GREEN << "-R, --rate-limit <rps>    " << PINK << "Rate limit (requests per second)   " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-p, --progress            " << PINK << "Show progress bar for downloads    " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-2, --http2               " << PINK << "Prefer HTTP/2 (if available)       " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "-3, --http3               " << PINK << "Prefer HTTP/3 (if available)       " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-C, --no-compress         " << PINK << "Disable compression                " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-D, --dns-cache           " << PINK << "Enable DNS caching                 " << GREY << "│\n";
     std::cout << "│  " << GREEN << "-S, --stats               " << PINK << "Show detailed statistics           " << GREY << "│\n";
@@ -347,6 +499,12 @@ void print_usage(const char* prog_name) {
     std::cout << "│  " << RESET << "PERFORMANCE" << GREY << "                                                  │\n";
     std::cout << "│  " << GREEN << "--warmup <host>           " << PINK << "Pre-warm DNS cache for host        " << GREY << "│\n";
     std::cout << "│  " << GREEN << "--max-conn <num>          " << PINK << "Max concurrent connections         " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "--cache <dir>             " << PINK << "On-disk response cache (RFC 7234)  " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "--host-rate <rps>         " << PINK << "Per-host rate limit (politeness)   " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "--preconnect <n>          " << PINK << "Open n warm conns before request   " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "--trace <file>            " << PINK << "Write Chrome trace JSON to file    " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "--hedge <ms>              " << PINK << "Duplicate slow requests (0 = p95)  " << GREY << "│\n";
+    std::cout << "│  " << GREEN << "--resume                  " << PINK << "Resume interrupted -P -o download  " << GREY << "│\n";
     std::cout << "├───────────────────────────────────────────────────────────────┤\n";
     std::cout << "│  " << RESET << "EXAMPLES" << GREY << "                                                     │\n";
     std::cout << "│  " << PINK << "└─ crawl https://example.com                                 " << GREY << "│\n";
@@ -380,10 +538,183 @@ void output_json(const Response& resp, const std::string& url) {
     std::cout << "}\n";
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// Streaming batch mode
+//   URLs are read lazily into a bounded queue and a fixed worker set consumes
+//   them, so a 10M-line list never sits in memory: the reader blocks when the
+//   workers fall behind (backpressure) and every result is emitted the moment
+//   it completes. Bodies are streamed too — into per-URL files when -o names
+//   a directory, otherwise counted and dropped.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// "https://example.com/a/b?x=1" → "000042_https_example.com_a_b_x_1"
+static std::string batch_body_filename(size_t line_no, const std::string& url) {
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "%06zu_", line_no);
+    std::string name = prefix;
+    for (char c : url) {
+        name += (isalnum((unsigned char)c) || c == '.' || c == '-') ? c : '_';
+        if (name.size() >= 200) break; // keep well under filesystem limits
+    }
+    return name;
+}
+
+// Minimal JSON string escaping for NDJSON summary lines
+static std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20) { out += ' '; }
+        else out += c;
+    }
+    return out;
+}
+
+static int run_batch_streaming(HTTPClient& client, const std::string& batch_file,
+                               const Request& proto, int parallel,
+                               const std::string& output_dir, bool json_output,
+                               bool verbose, bool show_stats) {
+    std::ifstream file(batch_file);
+    if (!file) {
+        std::cerr << "Error: Cannot open batch file: " << batch_file << "\n";
+        return 1;
+    }
+
+    struct BatchLine {
+        size_t line_no;
+        std::string url;
+    };
+
+    // Bounded queue: deep enough to keep workers fed, small enough that
+    // memory stays flat regardless of list size
+    const size_t queue_cap = std::max((size_t)64, (size_t)parallel * 4);
+    std::deque<BatchLine> queue;
+    std::mutex queue_mutex;
+    std::condition_variable can_push, can_pop;
+    bool done_reading = false;
+
+    std::atomic<size_t> total{0};
+    std::atomic<size_t> success{0};
+    std::mutex out_mutex; // serialize NDJSON lines and warnings
+
+    auto worker = [&]() {
+        while (true) {
+            BatchLine item;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                can_pop.wait(lock, [&] { return !queue.empty() || done_reading; });
+                if (queue.empty()) {
+                    return;
+                }
+                item = std::move(queue.front());
+                queue.pop_front();
+            }
+            can_push.notify_one();
+
+            auto parsed = URLView::parse(item.url);
+            if (!parsed) {
+                std::lock_guard<std::mutex> lock(out_mutex);
+                std::cerr << "Warning: Invalid URL: " << item.url << "\n";
+                continue;
+            }
+
+            Request req = proto;
+            req.url = parsed->to_url();
+
+            // Stream the body so large responses never accumulate in memory
+            std::ofstream body_out;
+            size_t body_bytes = 0;
+            if (!output_dir.empty()) {
+                std::string path = output_dir + "/" +
+                                   batch_body_filename(item.line_no, item.url);
+                body_out.open(path, std::ios::binary);
+                req.body_sink = [&](const uint8_t* data, size_t len) {
+                    body_out.write(reinterpret_cast<const char*>(data), (std::streamsize)len);
+                    body_bytes += len;
+                    return body_out.good();
+                };
+            } else {
+                req.body_sink = [&](const uint8_t*, size_t len) {
+                    body_bytes += len;
+                    return true;
+                };
+            }
+
+            Response resp = client.request(req);
+            if (body_out.is_open()) {
+                body_out.close();
+            }
+
+            total.fetch_add(1, std::memory_order_relaxed);
+            bool ok = resp.status_code >= 200 && resp.status_code < 400;
+            if (ok) {
+                success.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            if (json_output) {
+                std::lock_guard<std::mutex> lock(out_mutex);
+                std::cout << "{\"url\":\"" << json_escape(item.url) << "\","
+                          << "\"status\":" << resp.status_code << ","
+                          << "\"elapsed_ms\":" << resp.elapsed_time.count() << ","
+                          << "\"bytes\":" << body_bytes << ","
+                          << "\"http2\":" << (resp.used_http2 ? "true" : "false")
+                          << "}\n";
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    threads.reserve(parallel);
+    for (int i = 0; i < parallel; ++i) {
+        threads.emplace_back(worker);
+    }
+
+    // The reader is the producer: it blocks when the queue is full, so file
+    // consumption proceeds exactly as fast as the workers drain it
+    std::string url;
+    size_t line_no = 0;
+    while (std::getline(file, url)) {
+        line_no++;
+        if (url.empty() || url[0] == '#') continue;
+
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        can_push.wait(lock, [&] { return queue.size() < queue_cap; });
+        queue.push_back({line_no, std::move(url)});
+        lock.unlock();
+        can_pop.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        done_reading = true;
+    }
+    can_pop.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (verbose) {
+        auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+        std::cerr << "* Completed in " << total_ms << " ms\n";
+        std::cerr << "* Success: " << success.load() << "/" << total.load() << "\n";
+    }
+
+    if (show_stats) {
+        client.get_stats()->print(true);
+    }
+
+    return (success.load() == total.load()) ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
     std::string method = "GET";
     std::string output_file;
     std::string data;
+    std::string upload_file;
     std::string user_agent;
     std::string batch_file;
     bool include_headers = false;
@@ -391,6 +722,7 @@ int main(int argc, char* argv[]) {
     bool follow_redirects = false;
     bool show_progress = false;
     bool use_http2 = false;
+    bool use_http3 = false;
     bool no_compress = false;
     bool use_dns_cache = false;
     bool show_stats = false;
@@ -398,16 +730,24 @@ int main(int argc, char* argv[]) {
     int max_time = 30;
     int retry_count = 0;
     double rate_limit = 0;
+    double host_rate_limit = 0;
+    int preconnect_n = 0;
+    std::string trace_file;
+    bool use_hedging = false;
+    int hedge_ms = 0;
+    bool resume = false;
     int parallel = 10;
     int max_conn = 200;
+    std::string cache_dir;
     std::vector<std::string> warmup_hosts;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     std::thread progress_updater; // Correct placement
 
     static struct option long_options[] = {
         {"request", required_argument, 0, 'X'},
         {"header", required_argument, 0, 'H'},
         {"data", required_argument, 0, 'd'},
+        {"upload-file", required_argument, 0, 'T'},
         {"output", required_argument, 0, 'o'},
         {"include", no_argument, 0, 'i'},
         {"verbose", no_argument, 0, 'v'},
@@ -418,6 +758,7 @@ int main(int argc, char* argv[]) {
         {"rate-limit", required_argument, 0, 'R'},
         {"progress", no_argument, 0, 'p'},
         {"http2", no_argument, 0, '2'},
+        {"http3", no_argument, 0, '3'},
         {"no-compress", no_argument, 0, 'C'},
         {"dns-cache", no_argument, 0, 'D'},
         {"stats", no_argument, 0, 'S'},
@@ -426,12 +767,18 @@ int main(int argc, char* argv[]) {
         {"json", no_argument, 0, 'J'},
         {"warmup", required_argument, 0, 1000},
         {"max-conn", required_argument, 0, 1001},
+        {"cache", required_argument, 0, 1002},
+        {"host-rate", required_argument, 0, 1003},
+        {"preconnect", required_argument, 0, 1004},
+        {"trace", required_argument, 0, 1005},
+        {"hedge", required_argument, 0, 1006},
+        {"resume", no_argument, 0, 1007},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
     
     int opt;
-    while ((opt = getopt_long(argc, argv, "X:H:d:o:ivLm:A:r:R:p2CDSB:P:Jh", long_options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "X:H:d:T:o:ivLm:A:r:R:p23CDSB:P:Jh", long_options, nullptr)) != -1) {
         switch (opt) {
             case 'X': method = optarg; break;
             case 'H': {
@@ -441,7 +788,7 @@ int main(int argc, char* argv[]) {
                     std::string key = header_str.substr(0, colon);
                     std::string value = header_str.substr(colon + 1);
                     value.erase(0, value.find_first_not_of(" \t"));
-                    headers[key] = value;
+                    headers.set(key, value);
                 }
                 break;
             }
@@ -449,6 +796,10 @@ int main(int argc, char* argv[]) {
                 data = optarg;
                 if (method == "GET") method = "POST";
                 break;
+            case 'T':
+                upload_file = optarg;
+                if (method == "GET") method = "PUT";
+                break;
             case 'o': output_file = optarg; break;
             case 'i': include_headers = true; break;
             case 'v': verbose = true; break;
@@ -459,6 +810,7 @@ int main(int argc, char* argv[]) {
             case 'R': rate_limit = std::atof(optarg); break;
             case 'p': show_progress = true; break;
             case '2': use_http2 = true; break;
+            case '3': use_http3 = true; break;
             case 'C': no_compress = true; break;
             case 'D': use_dns_cache = true; break;
             case 'S': show_stats = true; break;
@@ -467,6 +819,12 @@ int main(int argc, char* argv[]) {
             case 'J': json_output = true; break;
             case 1000: warmup_hosts.push_back(optarg); break;
             case 1001: max_conn = std::atoi(optarg); break;
+            case 1002: cache_dir = optarg; break;
+            case 1003: host_rate_limit = std::atof(optarg); break;
+            case 1004: preconnect_n = std::atoi(optarg); break;
+            case 1005: trace_file = optarg; break;
+            case 1006: use_hedging = true; hedge_ms = std::atoi(optarg); break;
+            case 1007: resume = true; break;
             case 'h':
                 print_usage(argv[0]);
                 return 0;
@@ -483,18 +841,39 @@ int main(int argc, char* argv[]) {
         client.set_user_agent(user_agent);
     }
     
+    if (!trace_file.empty()) {
+        trace::enable();
+    }
+    auto finish_trace = [&]() {
+        if (trace_file.empty()) return;
+        if (!trace::write(trace_file)) {
+            std::cerr << "Error: Cannot write trace file " << trace_file << "\n";
+        } else if (verbose) {
+            std::cerr << "* Trace written to " << trace_file << "\n";
+        }
+    };
+
     client.set_timeout(std::chrono::seconds(max_time));
     client.enable_http2(use_http2);
+    client.enable_http3(use_http3);
     client.enable_compression(!no_compress);
     client.set_max_connections(max_conn);
     
     if (rate_limit > 0) {
         client.set_rate_limit(rate_limit, static_cast<size_t>(rate_limit * 2));
     }
+
+    if (host_rate_limit > 0) {
+        client.set_per_host_rate_limit(host_rate_limit);
+    }
     
     if (use_dns_cache) {
         client.enable_dns_cache(true);
     }
+
+    if (!cache_dir.empty()) {
+        client.enable_disk_cache(true, cache_dir);
+    }
     
     // Warmup DNS
     for (const auto& host : warmup_hosts) {
@@ -504,67 +883,28 @@ int main(int argc, char* argv[]) {
         client.warmup_dns({host});
     }
     
-    // Batch mode
+    // Batch mode: streaming pipeline, memory stays flat however long the list
     if (!batch_file.empty()) {
-        std::ifstream file(batch_file);
-        if (!file) {
-            std::cerr << "Error: Cannot open batch file: " << batch_file << "\n";
-            return 1;
-        }
-        
-        std::vector<Request> requests;
-        std::string url;
-        
-        while (std::getline(file, url)) {
-            if (url.empty() || url[0] == '#') continue;
-            
-            auto parsed_url = URL::parse(url);
-            if (!parsed_url) {
-                std::cerr << "Warning: Invalid URL: " << url << "\n";
-                continue;
-            }
-            
-            Request req;
-            req.method = method;
-            req.url = *parsed_url;
-            req.headers = headers;
-            req.follow_redirects = follow_redirects;
-            req.timeout = std::chrono::seconds(max_time);
-            req.max_retries = retry_count;
-            req.enable_compression = !no_compress;
-            req.prefer_http2 = use_http2;
-            
-            requests.push_back(req);
-        }
-        
+        Request proto;
+        proto.method = method;
+        proto.headers = headers;
+        proto.follow_redirects = follow_redirects;
+        proto.timeout = std::chrono::seconds(max_time);
+        proto.max_retries = retry_count;
+        proto.enable_compression = !no_compress;
+        proto.prefer_http2 = use_http2;
+        proto.enable_hedging = use_hedging;
+        proto.hedge_delay = std::chrono::milliseconds(hedge_ms);
+
         if (verbose) {
-            std::cerr << "* Processing " << requests.size() << " URLs with " 
+            std::cerr << "* Processing " << batch_file << " with "
                       << parallel << " parallel connections...\n";
         }
-        
-        auto start = std::chrono::steady_clock::now();
-        auto responses = client.batch_request(requests, parallel);
-        auto elapsed = std::chrono::steady_clock::now() - start;
-        
-        // Output results
-        size_t success = 0;
-        for (const auto& resp : responses) {
-            if (resp.status_code >= 200 && resp.status_code < 400) {
-                success++;
-            }
-        }
-        
-        if (verbose) {
-            auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
-            std::cerr << "* Completed in " << total_ms << " ms\n";
-            std::cerr << "* Success: " << success << "/" << responses.size() << "\n";
-        }
-        
-        if (show_stats) {
-            client.get_stats()->print(true);
-        }
-        
-        return (success == responses.size()) ? 0 : 1;
+
+        int rc = run_batch_streaming(client, batch_file, proto, parallel,
+                                     output_file, json_output, verbose, show_stats);
+        finish_trace();
+        return rc;
     }
     
     // Single URL mode
@@ -581,7 +921,16 @@ int main(int argc, char* argv[]) {
         std::cerr << "Error: Invalid URL\n";
         return 1;
     }
-    
+
+    // Start warming connections while the rest of the request is prepared
+    if (preconnect_n > 0) {
+        if (verbose) {
+            std::cerr << "* Pre-connecting " << preconnect_n << " connection(s) to "
+                      << parsed_url->host << ":" << parsed_url->port << "...\n";
+        }
+        client.preconnect(parsed_url->host, parsed_url->port, preconnect_n);
+    }
+
     Request req;
     req.method = method;
     req.url = *parsed_url;
@@ -591,11 +940,15 @@ int main(int argc, char* argv[]) {
     req.max_retries = retry_count;
     req.enable_compression = !no_compress;
     req.prefer_http2 = use_http2;
+    req.enable_hedging = use_hedging;
+    req.hedge_delay = std::chrono::milliseconds(hedge_ms);
     
-    if (!data.empty()) {
+    if (!upload_file.empty()) {
+        req.body_file = upload_file; // streamed, never loaded into memory
+    } else if (!data.empty()) {
         req.body.assign(data.begin(), data.end());
-        if (req.headers.find("Content-Type") == req.headers.end()) {
-            req.headers["Content-Type"] = "application/x-www-form-urlencoded";
+        if (!req.headers.contains("Content-Type")) {
+            req.headers.set("Content-Type", "application/x-www-form-urlencoded");
         }
     }
     
@@ -616,22 +969,19 @@ int main(int argc, char* argv[]) {
     size_t content_length = 0;
     bool supports_ranges  = false;
     // head_resp object declaration needs to be outside the if block if content_length/supports_ranges are to be used outside
-    Response head_resp_for_cl; 
-    if (parallel > 1 && !output_file.empty() && show_progress) {
+    Response head_resp_for_cl;
+    if (parallel > 1 && !output_file.empty() && (show_progress || resume)) {
         Request head_req  = req;
         head_req.method   = "HEAD";
         head_req.timeout  = std::chrono::seconds(5); // Shorter timeout for HEAD request
         head_resp_for_cl = client.request(head_req); // Store response
-        auto it_cl = head_resp_for_cl.headers.find("Content-Length");
-        if (it_cl == head_resp_for_cl.headers.end()) it_cl = head_resp_for_cl.headers.find("content-length");
-        if (it_cl != head_resp_for_cl.headers.end()) {
+        if (auto cl = head_resp_for_cl.headers.get("Content-Length")) {
             content_length = 0;
-            for (char c : it_cl->second)
+            for (char c : *cl)
                 if (c>='0' && c<='9') content_length = content_length*10+(c-'0');
         }
-        auto it_ar = head_resp_for_cl.headers.find("Accept-Ranges");
-        if (it_ar == head_resp_for_cl.headers.end()) it_ar = head_resp_for_cl.headers.find("accept-ranges");
-        if (it_ar != head_resp_for_cl.headers.end() && it_ar->second.find("bytes") != std::string::npos)
+        auto ar = head_resp_for_cl.headers.get("Accept-Ranges");
+        if (ar && ar->find("bytes") != std::string_view::npos)
             supports_ranges = true;
     }
 
@@ -645,6 +995,42 @@ int main(int argc, char* argv[]) {
         g_total = 0; // Explicitly set g_total to 0 if content_length not found
     }
 
+    bool use_parallel = parallel > 1 && content_length > 0 && supports_ranges &&
+                        !output_file.empty();
+
+    // Validators for the resume sidecar — whichever the server offers
+    std::string etag, last_modified;
+    if (auto et = head_resp_for_cl.headers.get("ETag")) etag = std::string(*et);
+    if (auto lm = head_resp_for_cl.headers.get("Last-Modified")) last_modified = std::string(*lm);
+    if (resume && !use_parallel) {
+        std::cerr << "Warning: --resume needs a parallel range download "
+                     "(-P > 1, -o, and a server with Accept-Ranges); ignoring\n";
+    }
+
+    // ── Streaming output: with -o (and no header/JSON decoration) body bytes
+    // are written straight to the file as they arrive instead of being
+    // buffered in Response::body — memory stays flat for huge downloads.
+    // Parallel mode manages the output file itself (pwrite at offsets). ────
+    std::ofstream file_out;
+    std::unique_ptr<AsyncFileWriter> async_out;
+    size_t async_off = 0;
+    if (!output_file.empty() && !include_headers && !json_output && !use_parallel) {
+        // Async writer stage: disk writes overlap the download instead of
+        // stalling the receive loop on every flush
+        async_out = std::make_unique<AsyncFileWriter>(output_file);
+        if (!async_out->valid()) {
+            std::cerr << "Error: Cannot open output file\n";
+            return 1;
+        }
+        req.body_sink = [&](const uint8_t* data, size_t len) {
+            if (!async_out->write(async_off, data, len)) {
+                return false;
+            }
+            async_off += len;
+            return true;
+        };
+    }
+
     // Start progress thread only after g_total is initialized
     // std::thread progress_updater; // Declared earlier.
     if (show_progress && !output_file.empty()) {
@@ -654,20 +1040,16 @@ int main(int argc, char* argv[]) {
 
     auto start = std::chrono::steady_clock::now();
     Response resp;
-    std::vector<uint8_t> parallel_body;
     bool parallel_download_performed = false; // Flag to track if parallel download happened
 
-    if (parallel > 1 && content_length > 0 && supports_ranges && !output_file.empty()) {
-        // ── Parallel range download ────────────────────────────────────────
-        // if (verbose)
-        //     std::cerr << "* Parallel download: " << parallel << " pipes, "
-        //               << format_size(content_length) << " total\n";
-        parallel_body = parallel_download(url, content_length, parallel,
-                                          show_progress, client, method, headers,
-                                          max_time, no_compress);
-        resp.status_code = parallel_body.empty() ? 0 : 206;
-        resp.body        = parallel_body;
-        resp.bytes_received = resp.body.size();
+    if (use_parallel) {
+        // ── Parallel range download — writes directly into output_file ─────
+        bool ok = parallel_download(url, output_file, content_length, parallel,
+                                    show_progress, client, method, headers,
+                                    max_time, no_compress, resume,
+                                    etag, last_modified);
+        resp.status_code = ok ? 206 : 0;
+        resp.bytes_received = ok ? content_length : 0;
         parallel_download_performed = true; // Set flag
     } else {
         // ── Single pipe download (progress callback already set) ───────────
@@ -675,11 +1057,9 @@ int main(int argc, char* argv[]) {
 
         // For single downloads, set g_total if content_length is available
         if (!parallel_download_performed && show_progress && !output_file.empty()) {
-            auto it_cl = resp.headers.find("Content-Length");
-            if (it_cl == resp.headers.end()) it_cl = resp.headers.find("content-length");
-            if (it_cl != resp.headers.end()) {
+            if (auto cl = resp.headers.get("Content-Length")) {
                 size_t cl_val = 0;
-                for (char c : it_cl->second)
+                for (char c : *cl)
                     if (c>='0' && c<='9') cl_val = cl_val*10+(c-'0');
                 g_total = cl_val;
             } else {
@@ -718,6 +1098,20 @@ int main(int argc, char* argv[]) {
         if (resp.redirect_count > 0) std::cerr << "* Redirects: " << resp.redirect_count << "\n";
     }
     
+    // Close out the async writer: blocks until the last block is durable.
+    // Non-2xx bodies stay buffered in resp.body, so land them here too.
+    if (async_out) {
+        if (!resp.body.empty()) {
+            async_out->write(async_off, resp.body.data(), resp.body.size());
+        }
+        if (!async_out->finish() && resp.status_code != 0) {
+            std::cerr << "Error: Write to output file failed\n";
+            return 1;
+        }
+    }
+
+    finish_trace(); // dump spans whether the run succeeded or stalled
+
     if (resp.status_code == 0) {
         std::cerr << "Error: Connection failed\n";
         return 1;
@@ -728,31 +1122,35 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
-    // Output response
-    std::ostream* out = &std::cout;
-    std::ofstream file_out;
-    
-    if (!output_file.empty()) {
-        file_out.open(output_file, std::ios::binary);
-        if (!file_out) {
-            std::cerr << "Error: Cannot open output file\n";
-            return 1;
+    // Output response — parallel mode and the async writer already wrote
+    // the file in place
+    if (!parallel_download_performed && !async_out) {
+        std::ostream* out = &std::cout;
+
+        if (!output_file.empty()) {
+            if (!file_out.is_open()) {
+                file_out.open(output_file, std::ios::binary);
+                if (!file_out) {
+                    std::cerr << "Error: Cannot open output file\n";
+                    return 1;
+                }
+            }
+            out = &file_out;
         }
-        out = &file_out;
-    }
-    
-    if (include_headers) {
-        *out << "HTTP/1.1 " << resp.status_code << " " << resp.status_message << "\n";
-        for (const auto& [key, value] : resp.headers) {
-            *out << key << ": " << value << "\n";
+
+        if (include_headers) {
+            *out << "HTTP/1.1 " << resp.status_code << " " << resp.status_message << "\n";
+            for (const auto& [key, value] : resp.headers) {
+                *out << key << ": " << value << "\n";
+            }
+            *out << "\n";
         }
-        *out << "\n";
+
+        out->write(reinterpret_cast<const char*>(resp.body.data()), resp.body.size());
     }
-    
-    out->write(reinterpret_cast<const char*>(resp.body.data()), resp.body.size());
-    
+
     if (verbose && !output_file.empty()) {
-        std::cerr << "* Saved to " << output_file << " (" << format_size(resp.body.size()) << ")\n";
+        std::cerr << "* Saved to " << output_file << " (" << format_size(resp.bytes_received) << ")\n";
     }
     
     if (show_stats) {
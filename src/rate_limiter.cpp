@@ -4,87 +4,110 @@
 
 namespace crawl {
 
-RateLimiter::RateLimiter(double requests_per_second, size_t burst)
-    : rate_(requests_per_second),
-      burst_(burst == 0 ? static_cast<size_t>(requests_per_second) : burst),
-      last_refill_(std::chrono::steady_clock::now()) {
-    
-    if (rate_ > 0) {
-        interval_ = std::chrono::nanoseconds(
-            static_cast<long long>(1'000'000'000.0 / rate_)
-        );
-    }
+int64_t RateLimiter::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-void RateLimiter::refill() {
-    if (rate_ <= 0) return; // Unlimited
-    
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = now - last_refill_;
-    
-    // Calculate how many tokens to add
-    auto tokens_to_add = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / interval_.count();
-    
-    if (tokens_to_add > 0) {
-        // Add tokens up to burst limit
-        while (tokens_.size() < burst_ && tokens_to_add > 0) {
-            tokens_.push_back(now);
-            tokens_to_add--;
-        }
-        
-        last_refill_ = now;
+RateLimiter::RateLimiter(double requests_per_second, size_t burst) {
+    set_rate(requests_per_second, burst);
+}
+
+void RateLimiter::set_rate(double requests_per_second, size_t burst) {
+    rate_.store(requests_per_second, std::memory_order_relaxed);
+
+    if (requests_per_second > 0) {
+        int64_t interval = static_cast<int64_t>(1'000'000'000.0 / requests_per_second);
+        if (interval < 1) interval = 1;
+
+        size_t b = (burst == 0) ? static_cast<size_t>(requests_per_second) : burst;
+        if (b < 1) b = 1;
+
+        interval_ns_.store(interval, std::memory_order_relaxed);
+        burst_ns_.store(static_cast<int64_t>(b) * interval, std::memory_order_relaxed);
     }
+    next_free_ns_.store(now_ns(), std::memory_order_release);
 }
 
 void RateLimiter::acquire() {
-    if (rate_ <= 0) return; // Unlimited
-    
-    std::unique_lock<std::mutex> lock(mutex_);
-    
-    while (true) {
-        refill();
-        
-        if (!tokens_.empty()) {
-            tokens_.pop_front();
+    if (rate_.load(std::memory_order_relaxed) <= 0) return; // Unlimited
+
+    int64_t interval = interval_ns_.load(std::memory_order_relaxed);
+    int64_t burst = burst_ns_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        int64_t now = now_ns();
+        int64_t old = next_free_ns_.load(std::memory_order_acquire);
+
+        // Idle time accrues tokens, but never more than the burst allowance
+        int64_t token_time = std::max(old, now - burst);
+
+        if (next_free_ns_.compare_exchange_weak(old, token_time + interval,
+                                                std::memory_order_acq_rel)) {
+            // The claimed token may lie in the future — sleep until it's ours
+            if (token_time > now) {
+                std::this_thread::sleep_for(
+                    std::chrono::nanoseconds(token_time - now));
+            }
             return;
         }
-        
-        // Wait for next token
-        lock.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        lock.lock();
     }
 }
 
 bool RateLimiter::try_acquire() {
-    if (rate_ <= 0) return true; // Unlimited
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    refill();
-    
-    if (!tokens_.empty()) {
-        tokens_.pop_front();
-        return true;
+    if (rate_.load(std::memory_order_relaxed) <= 0) return true; // Unlimited
+
+    int64_t interval = interval_ns_.load(std::memory_order_relaxed);
+    int64_t burst = burst_ns_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        int64_t now = now_ns();
+        int64_t old = next_free_ns_.load(std::memory_order_acquire);
+
+        int64_t token_time = std::max(old, now - burst);
+        if (token_time > now) {
+            return false; // next token is in the future — would block
+        }
+        if (next_free_ns_.compare_exchange_weak(old, token_time + interval,
+                                                std::memory_order_acq_rel)) {
+            return true;
+        }
     }
-    
-    return false;
 }
 
-void RateLimiter::set_rate(double requests_per_second, size_t burst) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+// ─────────────────────────────────────────────────────────────────────────────
+// PerHostRateLimiter
+// ─────────────────────────────────────────────────────────────────────────────
+
+PerHostRateLimiter::PerHostRateLimiter(double requests_per_second, size_t burst)
+    : rate_(requests_per_second), burst_(burst) {}
+
+std::shared_ptr<RateLimiter> PerHostRateLimiter::bucket_for(const std::string& host) {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    auto& bucket = buckets_[host];
+    if (!bucket) {
+        bucket = std::make_shared<RateLimiter>(rate_, burst_);
+    }
+    return bucket;
+}
+
+void PerHostRateLimiter::acquire(const std::string& host) {
+    if (rate_ <= 0) return; // Unlimited — don't even touch the map
+    bucket_for(host)->acquire();
+}
+
+bool PerHostRateLimiter::try_acquire(const std::string& host) {
+    if (rate_ <= 0) return true;
+    return bucket_for(host)->try_acquire();
+}
+
+void PerHostRateLimiter::set_rate(double requests_per_second, size_t burst) {
+    std::lock_guard<std::mutex> lock(map_mutex_);
     rate_ = requests_per_second;
-    burst_ = burst == 0 ? static_cast<size_t>(requests_per_second) : burst;
-    
-    if (rate_ > 0) {
-        interval_ = std::chrono::nanoseconds(
-            static_cast<long long>(1'000'000'000.0 / rate_)
-        );
+    burst_ = burst;
+    for (auto& [host, bucket] : buckets_) {
+        bucket->set_rate(requests_per_second, burst);
     }
-    
-    tokens_.clear();
-    last_refill_ = std::chrono::steady_clock::now();
 }
 
 } // namespace crawl
@@ -1,4 +1,5 @@
 #include "stats.hpp"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -92,7 +93,8 @@ static void timing_line(const std::string& label,
 // ──────────────────────────────────────────────────────────────────────────────
 Statistics::Statistics() {}
 
-void Statistics::record_request(std::chrono::milliseconds latency, size_t bytes_received) {
+void Statistics::record_request(std::chrono::milliseconds latency, size_t bytes_received,
+                                const std::string& host) {
     total_requests_++;
     total_bytes_received_ += bytes_received;
     uint64_t lat_ms = latency.count();
@@ -100,7 +102,36 @@ void Statistics::record_request(std::chrono::milliseconds latency, size_t bytes_
     uint64_t cur_min = min_latency_ms_.load();
     while (lat_ms < cur_min && !min_latency_ms_.compare_exchange_weak(cur_min, lat_ms));
     uint64_t cur_max = max_latency_ms_.load();
-    while (lat_ms > cur_max && !max_latency_ms_.compare_exchange_weak(cur_max, lat_ms));
+    while (lat_ms > cur_max && !max_latency_ms_.compare_exchange_weak(cur_max, lat_ms)) {
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(hist_mutex_);
+        latency_hist_.record(lat_ms);
+    }
+
+    if (!host.empty()) {
+        std::shared_ptr<HostHist> hh;
+        {
+            std::lock_guard<std::mutex> lock(host_mutex_);
+            auto& slot = host_hists_[host];
+            if (!slot) {
+                slot = std::make_shared<HostHist>();
+            }
+            hh = slot;
+        }
+        std::lock_guard<std::mutex> lock(hh->mutex);
+        hh->hist.record(lat_ms);
+    }
+}
+
+std::chrono::milliseconds Statistics::latency_percentile(double p) const {
+    std::lock_guard<std::mutex> lock(hist_mutex_);
+    if (latency_hist_.count() < 20) {
+        return std::chrono::milliseconds(0); // too few samples to trust
+    }
+    // Callers pass a fraction (0.95); the histogram wants 0..100
+    return std::chrono::milliseconds(latency_hist_.percentile(p * 100.0));
 }
 
 void Statistics::record_connection(bool reused) {
@@ -114,6 +145,12 @@ void Statistics::record_error(const std::string& error_type) {
     error_counts_[error_type]++;
 }
 
+void Statistics::record_protocol(const std::string& proto) {
+    if      (proto == "h3") http3_requests_++;
+    else if (proto == "h2") http2_requests_++;
+    else                    http1_requests_++;
+}
+
 void Statistics::record_dns_lookup(std::chrono::milliseconds duration, bool cached) {
     dns_lookups_++;
     if (cached) dns_cache_hits_++;
@@ -151,6 +188,9 @@ Statistics::Stats Statistics::get_stats() const {
     s.total_bytes_sent    = total_bytes_sent_;
     s.connections_created = connections_created_;
     s.connections_reused  = connections_reused_;
+    s.http1_requests      = http1_requests_;
+    s.http2_requests      = http2_requests_;
+    s.http3_requests      = http3_requests_;
     s.dns_lookups         = dns_lookups_;
     s.dns_cache_hits      = dns_cache_hits_;
 
@@ -170,6 +210,39 @@ Statistics::Stats Statistics::get_stats() const {
     s.avg_first_byte_ms = fb_c > 0 ? static_cast<double>(total_first_byte_ms_) / fb_c : 0;
     s.avg_last_byte_ms  = s.avg_latency_ms;
 
+    {
+        std::lock_guard<std::mutex> lock(hist_mutex_);
+        s.p50_latency_ms = (double)latency_hist_.percentile(50);
+        s.p95_latency_ms = (double)latency_hist_.percentile(95);
+        s.p99_latency_ms = (double)latency_hist_.percentile(99);
+    }
+
+    // Per-host breakdown, aggregated only here: copy the shard pointers,
+    // then percentile each host outside the map lock
+    {
+        std::vector<std::pair<std::string, std::shared_ptr<HostHist>>> hosts;
+        {
+            std::lock_guard<std::mutex> lock(host_mutex_);
+            hosts.assign(host_hists_.begin(), host_hists_.end());
+        }
+        for (auto& [host, hh] : hosts) {
+            std::lock_guard<std::mutex> lock(hh->mutex);
+            if (hh->hist.count() == 0) continue;
+            Stats::HostLatency hl;
+            hl.host     = host;
+            hl.requests = hh->hist.count();
+            hl.p50_ms   = (double)hh->hist.percentile(50);
+            hl.p95_ms   = (double)hh->hist.percentile(95);
+            hl.p99_ms   = (double)hh->hist.percentile(99);
+            s.slowest_hosts.push_back(std::move(hl));
+        }
+        std::sort(s.slowest_hosts.begin(), s.slowest_hosts.end(),
+                  [](const auto& a, const auto& b) { return a.p95_ms > b.p95_ms; });
+        if (s.slowest_hosts.size() > 5) {
+            s.slowest_hosts.resize(5); // top-N worth looking at
+        }
+    }
+
     {
         std::lock_guard<std::mutex> lock(info_mutex_);
         s.current_ip   = current_ip_.empty()   ? "N/A" : current_ip_;
@@ -186,6 +259,7 @@ Statistics::Stats Statistics::get_stats() const {
 void Statistics::reset() {
     total_requests_ = total_errors_ = total_bytes_received_ = total_bytes_sent_ = 0;
     connections_created_ = connections_reused_ = 0;
+    http1_requests_ = http2_requests_ = http3_requests_ = 0;
     dns_lookups_ = dns_cache_hits_ = 0;
     total_latency_ms_ = 0;
     min_latency_ms_  = 999999;
@@ -196,6 +270,10 @@ void Statistics::reset() {
     current_ip_.clear(); current_host_.clear(); is_secure_ = false;
     std::lock_guard<std::mutex> l2(error_mutex_);
     error_counts_.clear();
+    std::lock_guard<std::mutex> l3(hist_mutex_);
+    latency_hist_.reset();
+    std::lock_guard<std::mutex> l4(host_mutex_);
+    host_hists_.clear();
 }
 
 void Statistics::print_line(const std::string& label, const std::string& value,
@@ -254,6 +332,11 @@ void Statistics::print(bool /*detailed*/) const {
     //   "Data Received:" (14) → pad = " " (1)
     stat_line("╟─", "Requests:",      "      ", fmtu(s.total_requests),        W);
     stat_line("╟─", "Errors:",        "        ", fmtu(s.total_errors),         W);
+    // "Protocols:" (10) → pad = "     " (5) → 1+2+1+1+1+10+5 = 21
+    stat_line("╟─", "Protocols:",     "     ",
+              "h1:" + fmtu(s.http1_requests) +
+              " h2:" + fmtu(s.http2_requests) +
+              " h3:" + fmtu(s.http3_requests), W);
     stat_line("╙─", "Data Received:", " ",
               fmt2(s.total_bytes_received / 1024.0) + " KB", W);
 
@@ -307,6 +390,38 @@ void Statistics::print(bool /*detailed*/) const {
               << C_RED << "│" << C_RESET
               << C_GREY << "  ║\n" << C_RESET;
 
+    // Percentile rows — from the full distribution, not the avg/min/max
+    // atomics, so the tail is visible
+    std::cout << C_GREY << "║  " << C_RESET
+              << C_RED
+              << "├──────────────────┼──────────────────┼──────────────────┤"
+              << C_RESET
+              << C_GREY << "  ║\n" << C_RESET;
+
+    std::cout << C_GREY << "║  " << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_GREEN << "        p50       " << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_GREEN << "        p95       " << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_GREEN << "        p99       " << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_GREY << "  ║\n" << C_RESET;
+
+    std::string p50_s = center18(fmt2(s.p50_latency_ms));
+    std::string p95_s = center18(fmt2(s.p95_latency_ms));
+    std::string p99_s = center18(fmt2(s.p99_latency_ms));
+
+    std::cout << C_GREY << "║  " << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_PINK << p50_s << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_PINK << p95_s << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_PINK << p99_s << C_RESET
+              << C_RED << "│" << C_RESET
+              << C_GREY << "  ║\n" << C_RESET;
+
     std::cout << C_GREY << "║  " << C_RESET
               << C_RED
               << "╰──────────────────┴──────────────────┴──────────────────╯"
@@ -344,6 +459,39 @@ void Statistics::print(bool /*detailed*/) const {
 
     std::cout << C_GREY << "╚══════════════════════════════════════════════════════════════╝\n" << C_RESET;
 
+    // ── SLOWEST HOSTS ──────────────────────────────────────────────────────
+    // Per-host p95 breakdown — only shown once several origins were hit,
+    // since with a single host it just repeats the latency table
+    if (s.slowest_hosts.size() > 1) {
+        std::cout << C_GREY << "╔══════════════════════════════════════════════════════════════╗\n" << C_RESET;
+        {
+            std::string unc = "║  SLOWEST HOSTS (p95)";
+            std::string col = std::string(C_GREY) + "║" + C_RESET + "  " +
+                              C_GREEN + "SLOWEST HOSTS (p95)" + C_RESET;
+            box_line(unc, col, W);
+        }
+
+        for (size_t i = 0; i < s.slowest_hosts.size(); ++i) {
+            const auto& hl = s.slowest_hosts[i];
+            std::string label = hl.host;
+            if (label.size() > 20) {
+                label = label.substr(0, 19) + "…";
+            }
+            label += ":";
+            // Values start at a fixed column like the other panels;
+            // prefix before the label is 6 display cols
+            int pad = 28 - 6 - disp_w(label);
+            if (pad < 1) pad = 1;
+            std::string value = fmt2(hl.p95_ms) + " ms  p99 " + fmt2(hl.p99_ms) +
+                                "  (" + fmtu(hl.requests) + " req)";
+            const char* connector =
+                (i + 1 == s.slowest_hosts.size()) ? "╙─" : "╟─";
+            stat_line(connector, label, std::string(pad, ' '), value, W);
+        }
+
+        std::cout << C_GREY << "╚══════════════════════════════════════════════════════════════╝\n" << C_RESET;
+    }
+
     // ── DETAILED TIMING ────────────────────────────────────────────────────
     std::cout << C_GREY << "╔══════════════════════════════════════════════════════════════╗\n" << C_RESET;
     {
@@ -0,0 +1,114 @@
+#include "trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+
+namespace crawl {
+namespace trace {
+
+namespace {
+
+std::atomic<bool> g_enabled{false};
+
+struct Event {
+    const char* name;  // string literal, by pointer
+    uint64_t ts_us;    // span start
+    uint32_t dur_us;   // span length, saturated at ~71 minutes
+};
+
+// One ring per thread: single writer, written without synchronization. The
+// registry owns the buffers so events survive their thread exiting; they are
+// only read under the registry lock from write(), after the run.
+struct RingBuffer {
+    static constexpr size_t CAPACITY = 65536;
+
+    explicit RingBuffer(int tid) : tid(tid) { events.resize(CAPACITY); }
+
+    int tid;
+    std::vector<Event> events;
+    size_t head = 0;     // next write slot
+    bool wrapped = false;
+};
+
+std::mutex g_registry_mutex;
+std::vector<std::unique_ptr<RingBuffer>> g_buffers;
+std::atomic<int> g_next_tid{1};
+
+RingBuffer& thread_buffer() {
+    thread_local RingBuffer* buf = nullptr;
+    if (!buf) {
+        auto owned = std::make_unique<RingBuffer>(
+            g_next_tid.fetch_add(1, std::memory_order_relaxed));
+        buf = owned.get();
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        g_buffers.push_back(std::move(owned));
+    }
+    return *buf;
+}
+
+} // anonymous namespace
+
+void enable() {
+    g_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void emit(const char* name, uint64_t start_us, uint64_t end_us) {
+    RingBuffer& buf = thread_buffer();
+    Event& e = buf.events[buf.head];
+    e.name = name;
+    e.ts_us = start_us;
+    uint64_t dur = end_us - start_us;
+    e.dur_us = dur > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(dur);
+    if (++buf.head == RingBuffer::CAPACITY) {
+        buf.head = 0;
+        buf.wrapped = true;
+    }
+}
+
+bool write(const std::string& path) {
+    FILE* f = ::fopen(path.c_str(), "w");
+    if (!f) {
+        return false;
+    }
+
+    int pid = ::getpid();
+    bool first = true;
+    fputs("[\n", f);
+
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    for (const auto& buf : g_buffers) {
+        size_t count = buf->wrapped ? RingBuffer::CAPACITY : buf->head;
+        size_t start = buf->wrapped ? buf->head : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const Event& e = buf->events[(start + i) % RingBuffer::CAPACITY];
+            fprintf(f,
+                    "%s{\"name\":\"%s\",\"cat\":\"crawl\",\"ph\":\"X\","
+                    "\"pid\":%d,\"tid\":%d,\"ts\":%llu,\"dur\":%u}",
+                    first ? "" : ",\n", e.name, pid, buf->tid,
+                    (unsigned long long)e.ts_us, e.dur_us);
+            first = false;
+        }
+    }
+
+    fputs("\n]\n", f);
+    bool ok = (fclose(f) == 0);
+    return ok;
+}
+
+} // namespace trace
+} // namespace crawl